@@ -0,0 +1,124 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "aliastable.h"
+#include "network.h"
+#include "networkgraph.h"
+
+using namespace std;
+
+aliasTable::aliasTable() { clear(); }
+
+void aliasTable::clear() {
+  offsets.assign(1, 0);
+  items.clear();
+  aliases.clear();
+  thresholds.clear();
+}
+
+// Vose's construction. Rows with a zero total weight are left empty.
+void aliasTable::addRow(const vector<int> &rowItems,
+                        const vector<double> &weights) {
+  int size = rowItems.size();
+  double sum(0);
+  for (int k = 0; k < size; ++k) sum += weights[k];
+  if (size == 0 || sum <= 0) {
+    offsets.push_back(items.size());
+    return;
+  }
+
+  int first = items.size();
+  items.insert(items.end(), rowItems.begin(), rowItems.end());
+  aliases.resize(first + size);
+  thresholds.resize(first + size);
+
+  vector<double> scaled(size);
+  vector<int> small, large;
+  for (int k = 0; k < size; ++k) {
+    scaled[k] = weights[k] * size / sum;
+    aliases[first + k] = k;
+    if (scaled[k] < 1)
+      small.push_back(k);
+    else
+      large.push_back(k);
+  }
+
+  while (!small.empty() && !large.empty()) {
+    int s = small.back(), l = large.back();
+    small.pop_back();
+    thresholds[first + s] = scaled[s];
+    aliases[first + s] = l;
+    scaled[l] -= 1 - scaled[s];
+    if (scaled[l] < 1) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // what remains is 1 up to rounding
+  for (unsigned k = 0; k < small.size(); ++k) thresholds[first + small[k]] = 1;
+  for (unsigned k = 0; k < large.size(); ++k) thresholds[first + large[k]] = 1;
+
+  offsets.push_back(items.size());
+}
+
+int aliasTable::choose(int row, double dice) const {
+  int first = offsets[row];
+  int size = offsets[row + 1] - first;
+  if (size == 0) return -1;
+
+  double scaled = dice * size;
+  int k = min(int(scaled), size - 1);
+  if (scaled - k >= thresholds[first + k]) k = aliases[first + k];
+  return items[first + k];
+}
+
+int aliasTable::getRowsNumber() const { return offsets.size() - 1; }
+
+// the pores leaving each node weighted by their flow, and the inlet pores by
+// the flow they bring in
+void network::buildFlowRoutes() {
+  updateNetworkGraph();
+  const networkGraph &graph = *nodePores;
+
+  aliasTable &outflows = *outflowRoutes;
+  outflows.clear();
+  vector<int> rowItems;
+  vector<double> weights;
+  for (int i = 0; i < totalNodes; ++i) {
+    rowItems.clear();
+    weights.clear();
+    if (!getNode(i)->getClosed())
+      for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j) {
+        pore *p = getPore(graph.pores[j]);
+        if (!p->getClosed() && graph.signs[j] * p->getFlow() < 0) {
+          rowItems.push_back(graph.pores[j]);
+          weights.push_back(abs(p->getFlow()));
+        }
+      }
+    outflows.addRow(rowItems, weights);
+  }
+
+  rowItems.clear();
+  weights.clear();
+  for (int i = 0; i < totalPores; ++i) {
+    pore *p = getPore(i);
+    if (!p->getClosed() && p->getInlet()) {
+      rowItems.push_back(i);
+      weights.push_back(abs(p->getFlow()));
+    }
+  }
+  inletRoutes->clear();
+  inletRoutes->addRow(rowItems, weights);
+
+  flowRoutesOutdated = false;
+}
+
+void network::updateFlowRoutes() {
+  if (flowRoutesOutdated || outflowRoutes->getRowsNumber() != totalNodes)
+    buildFlowRoutes();
+}
@@ -0,0 +1,34 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ALIASTABLE_H
+#define ALIASTABLE_H
+
+#include <vector>
+
+// Rows of Walker alias tables: choose(row, dice) returns one of the items of a
+// row with a probability proportional to its weight, in constant time, from a
+// single uniform number in [0, 1). Entry k of a row keeps its own item when
+// the fractional part of dice * size is below thresholds[k], and takes the
+// item of the entry aliases[k] of the same row otherwise.
+struct aliasTable {
+  aliasTable();
+
+  void clear();
+  void addRow(const std::vector<int> &rowItems,
+              const std::vector<double> &weights);
+  int choose(int row, double dice) const;
+
+  int getRowsNumber() const;
+
+  std::vector<int> offsets;
+  std::vector<int> items;
+  std::vector<int> aliases;
+  std::vector<double> thresholds;
+};
+
+#endif  // ALIASTABLE_H
@@ -6,6 +6,10 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "diffusionstencil.h"
+#include "networkarrays.h"
+#include "networkgraph.h"
+#include "tissuecoupling.h"
 
 using namespace std;
 
@@ -14,29 +18,20 @@ double network::runHaematocritFlow() {
   double hy = yEdgeLength / meshSizeY;
   double hz = zEdgeLength / meshSizeZ;
 
-  double coefX = 1 / pow(hx, 2);
-  double coefY = 1 / pow(hy, 2);
-  double coefZ = 1 / pow(hz, 2);
   double coeff = 1 / pow(hx, 2) + 1 / pow(hy, 2) + 1 / pow(hz, 2);
 
+  const tissueCoupling& exchange = *tissueExchange;
+  networkArrays& a = *vesselArrays;
+  int poresNumber = a.getPoresNumber();
+
   // set time step
 
   double flowTimeStep = 1e50;
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed() && abs(p->getFlow()) > 1e-20) {
-      double sumSource = 0;
-      auto& neigh = p->neighbooringBlocksArea();
-      for (auto iterator : neigh) {
-        int blockID = iterator.first;
-        block* bb = getBlock(blockID - 1);
-        if (!bb->getClosed()) {
-          double area = iterator.second;
-          sumSource += p->getMembranePermeability() * area / (p->getVolume());
-        }
-      }
-
-      double step = 1. / (abs(p->getFlow()) / p->getVolume() + sumSource);
+  for (int i = 0; i < poresNumber; ++i) {
+    if (abs(a.poreFlow[i]) > 1e-20) {
+      double sumSource =
+          exchange.poreExchange[a.poreIndex[i]] / a.poreVolume[i];
+      double step = 1. / (abs(a.poreFlow[i]) / a.poreVolume[i] + sumSource);
       if (step < flowTimeStep) flowTimeStep = step;
     }
   }
@@ -45,19 +40,7 @@ double network::runHaematocritFlow() {
     for (int i = 0; i < totalBlocks; ++i) {
       block* n = getBlock(i);
       if (!n->getClosed()) {
-        double sumSource = 0;
-
-        map<int, double>& neigh = n->neighbooringVesselsArea();
-        for (auto iterator : neigh) {
-          int poreID = iterator.first;
-          pore* pp = getPore(poreID - 1);
-          if (!pp->getClosed()) {
-            double area = iterator.second;
-            sumSource +=
-                pp->getMembranePermeability() * area / (n->getVolume());
-          }
-        }
-
+        double sumSource = exchange.blockExchange[i] / n->getVolume();
         double step =
             1. / (2 * n->getDiffusivity() * coeff + sumSource + sigma);
         if (step < flowTimeStep) flowTimeStep = step;
@@ -66,174 +49,61 @@ double network::runHaematocritFlow() {
 
   double deltaT = flowTimeStep;
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      if (!p->getInlet())  // inlet pore
-      {
-        p->getFeedingVessels().clear();
-        double totalInflow(0);
-        vector<pore*> connectedPores = p->getNeighboors();
-        for (unsigned j = 0; j < connectedPores.size(); j++) {
-          pore* npore = connectedPores[j];
-          if (!npore->getClosed()) {
-            if ((p->getFlow() > 0 && npore->getFlow() > 0 &&
-                 npore->getNodeIn() == p->getNodeOut()) ||
-                (p->getFlow() > 0 && npore->getFlow() < 0 &&
-                 npore->getNodeOut() == p->getNodeOut()) ||
-                (p->getFlow() < 0 && npore->getFlow() > 0 &&
-                 npore->getNodeIn() == p->getNodeIn()) ||
-                (p->getFlow() < 0 && npore->getFlow() < 0 &&
-                 npore->getNodeOut() == p->getNodeIn())) {
-              p->getFeedingVessels()[npore->getId()] = abs(npore->getFlow());
-              totalInflow += abs(npore->getFlow());
-            }
-          }
-        }
-        p->setInflowShare(abs(p->getFlow()) / totalInflow);
-      }
-    }
-  }
-
   vector<double> blockConcentration;
-  vector<double> poreConcentration;
-
   if (updateBlockAttributes) blockConcentration.reserve(totalBlocks);
-  poreConcentration.reserve(totalPores);
 
-  if (updateBlockAttributes)
+  vector<double> blockValues(totalBlocks), poreValues(totalPores, 0);
+  vector<double> blockSources, poreSources;
+  for (int i = 0; i < totalBlocks; ++i)
+    blockValues[i] = getBlock(i)->getHDConcentration();
+  for (int i = 0; i < poresNumber; ++i)
+    poreValues[a.poreIndex[i]] = a.poreHDConcentration[i];
+  if (updateBlockAttributes) exchange.blockSources(poreValues, blockSources);
+  exchange.poreSources(blockValues, poreSources);
+
+  if (updateBlockAttributes) {
+    prepareTissueStencil();
+    setTissueStencilStep(deltaT);
+    diffusionStencil& stencil = *tissueStencil;
     for (int i = 0; i < totalBlocks; ++i) {
       block* n = getBlock(i);
-      if (!n->getClosed()) {
-        double ii = n->getX();
-        double jj = n->getY();
-        double kk = n->getZ();
-
-        block *nW, *nE, *nN, *nS, *nU, *nD;
-        nW = getBlock(ii - 1, jj, kk);
-        nE = getBlock(ii + 1, jj, kk);
-        nS = getBlock(ii, jj - 1, kk);
-        nN = getBlock(ii, jj + 1, kk);
-        nD = getBlock(ii, jj, kk - 1);
-        nU = getBlock(ii, jj, kk + 1);
-
-        double sumSource = 0;
-        double sumSource2 = 0;
-
-        map<int, double>& neigh = n->neighbooringVesselsArea();
-        for (auto iterator : neigh) {
-          int poreID = iterator.first;
-          pore* pp = getPore(poreID - 1);
-          if (!pp->getClosed()) {
-            double area = iterator.second;
-            sumSource +=
-                pp->getMembranePermeability() * area / (n->getVolume());
-            sumSource2 += pp->getHDConcentration() *
-                          pp->getMembranePermeability() * area /
-                          (n->getVolume());
-          }
-        }
-
-        double newConcentration(0);
-
-        newConcentration += n->getHDConcentration() *
-                            (1 - deltaT * (2 * n->getDiffusivity() * coeff +
-                                           sumSource + sigma));
-        if (nW != 0)
-          if (!nW->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * nW->getHDConcentration();
-        if (nE != 0)
-          if (!nE->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * nE->getHDConcentration();
-        if (nS != 0)
-          if (!nS->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * nS->getHDConcentration();
-        if (nN != 0)
-          if (!nN->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * nN->getHDConcentration();
-        if (nD != 0)
-          if (!nD->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * nD->getHDConcentration();
-        if (nU != 0)
-          if (!nU->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * nU->getHDConcentration();
-
-        if (closedBoundaries) {
-          if (nW == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * n->getHDConcentration();
-          if (nE == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * n->getHDConcentration();
-          if (nS == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * n->getHDConcentration();
-          if (nN == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * n->getHDConcentration();
-          if (nD == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * n->getHDConcentration();
-          if (nU == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * n->getHDConcentration();
-        }
-
-        newConcentration += deltaT * sumSource2;
-
-        blockConcentration.push_back(newConcentration);
-      }
+      int c = stencil.cells[i];
+      stencil.values[c] = n->getClosed() ? 0 : n->getHDConcentration();
+      stencil.source[c] = deltaT * blockSources[i] / n->getVolume();
     }
+    stencil.fillBoundaries(closedBoundaries);
+    stencil.apply();
+    for (int i = 0; i < totalBlocks; ++i)
+      if (!getBlock(i)->getClosed())
+        blockConcentration.push_back(stencil.result[stencil.cells[i]]);
+  }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      double sumSource = 0;
-      double sumSource2 = 0;
-      double sumInflow = 0;
-
-      auto& neigh = p->neighbooringBlocksArea();
-      for (auto iterator : neigh) {
-        int blockID = iterator.first;
-        block* bb = getBlock(blockID - 1);
-        if (!bb->getClosed()) {
-          double area = iterator.second;
-          sumSource += p->getMembranePermeability() * area / (p->getVolume());
-          sumSource2 += bb->getHDConcentration() *
-                        p->getMembranePermeability() * area / (p->getVolume());
-        }
-      }
-
-      if (p->getInlet()) {
-        double concentration = 1;
-        sumInflow = concentration * abs(p->getFlow()) / p->getVolume();
-      } else {
-        auto& neighPores = p->getFeedingVessels();
-        for (auto iterator : neighPores) {
-          pore* pp = getPore(iterator.first - 1);
-          double inflow = iterator.second;
-          if (!pp->getClosed()) {
-            sumInflow += pp->getHDConcentration() * p->getInflowShare() *
-                         inflow / p->getVolume();
-          }
-        }
+  vector<double> poreConcentration(poresNumber);
+  for (int i = 0; i < poresNumber; ++i) {
+    int index = a.poreIndex[i];
+    double sumSource = exchange.poreExchange[index] / a.poreVolume[i];
+    double sumSource2 = poreSources[index] / a.poreVolume[i];
+    double sumInflow = 0;
+
+    if (a.poreInlet[i]) {
+      double concentration = 1;
+      sumInflow = concentration * abs(a.poreFlow[i]) / a.poreVolume[i];
+    } else {
+      for (int j = a.feedingOffsets[i]; j < a.feedingOffsets[i + 1]; ++j) {
+        int q = a.feedingPores[j];
+        sumInflow += a.poreHDConcentration[q] * a.poreInflowShare[i] *
+                     a.feedingInflows[j] / a.poreVolume[i];
       }
+    }
 
-      double newConcentration(0);
-      newConcentration +=
-          p->getHDConcentration() *
-          (1 - deltaT * (abs(p->getFlow()) / p->getVolume() + sumSource));
-      newConcentration += deltaT * sumInflow;
-      newConcentration += deltaT * sumSource2;
+    double newConcentration(0);
+    newConcentration +=
+        a.poreHDConcentration[i] *
+        (1 - deltaT * (abs(a.poreFlow[i]) / a.poreVolume[i] + sumSource));
+    newConcentration += deltaT * sumInflow;
+    newConcentration += deltaT * sumSource2;
 
-      poreConcentration.push_back(newConcentration);
-    }
+    poreConcentration[i] = newConcentration;
   }
 
   unsigned j(0);
@@ -251,37 +121,27 @@ double network::runHaematocritFlow() {
       }
     }
 
-  j = 0;
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      p->setHDConcentration(poreConcentration[j]);
-      j++;
-      if (p->getHDConcentration() < 0 || p->getHDConcentration() > 1.001) {
-        cout << "pore concentration out of range: " << p->getHDConcentration()
-             << endl;
-        cancel = true;
-      }
+  for (int i = 0; i < poresNumber; ++i) {
+    double newConcentration = poreConcentration[i];
+    a.poreHDConcentration[i] = newConcentration;
+    if (newConcentration < 0 || newConcentration > 1.001) {
+      cout << "pore concentration out of range: " << newConcentration << endl;
+      cancel = true;
     }
   }
 
-  for (int i = 0; i < totalNodes; ++i) {
-    node* n = getNode(i);
-    if (!n->getClosed()) {
-      double concentration(0);
-      double neighboorsNumber(0);
-      vector<int> connectedPores = n->getConnectedPores();
-      for (unsigned j = 0; j < connectedPores.size(); j++) {
-        pore* npore = getPore(connectedPores[j] - 1);
-        if (!npore->getClosed()) {
-          concentration += npore->getHDConcentration();
-          neighboorsNumber++;
-        }
-      }
-      n->setHDConcentration(concentration / neighboorsNumber);
+  const networkGraph& graph = a.nodePores;
+  for (int i = 0; i < a.getNodesNumber(); ++i) {
+    double concentration(0);
+    double neighboorsNumber(0);
+    for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j) {
+      concentration += a.poreHDConcentration[graph.pores[j]];
+      neighboorsNumber++;
     }
+    a.nodeHDConcentration[i] = concentration / neighboorsNumber;
   }
 
+  scatterHaematocrit();
   emitPlotSignal();
 
   return flowTimeStep * flowRate;
@@ -292,30 +152,20 @@ double network::runHaematocritFlowWithPhaseSeparation() {
   double hy = yEdgeLength / meshSizeY;
   double hz = zEdgeLength / meshSizeZ;
 
-  double coefX = 1 / pow(hx, 2);
-  double coefY = 1 / pow(hy, 2);
-  double coefZ = 1 / pow(hz, 2);
   double coeff = 1 / pow(hx, 2) + 1 / pow(hy, 2) + 1 / pow(hz, 2);
 
+  const tissueCoupling& exchange = *tissueExchange;
+  networkArrays& a = *vesselArrays;
+  int poresNumber = a.getPoresNumber();
+
   // set time step
 
   double flowTimeStep = 1e50;
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed() && abs(p->getFlow()) > 1e-40 &&
-        p->getConductivity() != 1e-200) {
-      double sumSource = 0;
-      auto& neigh = p->neighbooringBlocksArea();
-      for (auto iterator : neigh) {
-        int blockID = iterator.first;
-        block* bb = getBlock(blockID - 1);
-        if (!bb->getClosed()) {
-          double area = iterator.second;
-          sumSource += p->getMembranePermeability() * area / (p->getVolume());
-        }
-      }
-
-      double step = 1. / (abs(p->getFlow()) / p->getVolume() + sumSource);
+  for (int i = 0; i < poresNumber; ++i) {
+    if (abs(a.poreFlow[i]) > 1e-40 && !a.poreIsolated[i]) {
+      double sumSource =
+          exchange.poreExchange[a.poreIndex[i]] / a.poreVolume[i];
+      double step = 1. / (abs(a.poreFlow[i]) / a.poreVolume[i] + sumSource);
       if (step < flowTimeStep) flowTimeStep = step;
     }
   }
@@ -326,19 +176,7 @@ double network::runHaematocritFlowWithPhaseSeparation() {
     for (int i = 0; i < totalBlocks; ++i) {
       block* n = getBlock(i);
       if (!n->getClosed()) {
-        double sumSource = 0;
-
-        map<int, double>& neigh = n->neighbooringVesselsArea();
-        for (auto iterator : neigh) {
-          int poreID = iterator.first;
-          pore* pp = getPore(poreID - 1);
-          if (!pp->getClosed()) {
-            double area = iterator.second;
-            sumSource +=
-                pp->getMembranePermeability() * area / (n->getVolume());
-          }
-        }
-
+        double sumSource = exchange.blockExchange[i] / n->getVolume();
         double step =
             1. / (2 * n->getDiffusivity() * coeff + sumSource + sigma);
         if (step < flowTimeStep) flowTimeStep = step;
@@ -347,174 +185,61 @@ double network::runHaematocritFlowWithPhaseSeparation() {
 
   double deltaT = flowTimeStep;
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      if (!p->getInlet())  // inlet pore
-      {
-        p->getFeedingVessels().clear();
-        double totalInflow(0);
-        vector<pore*> connectedPores = p->getNeighboors();
-        for (unsigned j = 0; j < connectedPores.size(); j++) {
-          pore* npore = connectedPores[j];
-          if (!npore->getClosed()) {
-            if ((p->getFlow() > 0 && npore->getFlow() > 0 &&
-                 npore->getNodeIn() == p->getNodeOut()) ||
-                (p->getFlow() > 0 && npore->getFlow() < 0 &&
-                 npore->getNodeOut() == p->getNodeOut()) ||
-                (p->getFlow() < 0 && npore->getFlow() > 0 &&
-                 npore->getNodeIn() == p->getNodeIn()) ||
-                (p->getFlow() < 0 && npore->getFlow() < 0 &&
-                 npore->getNodeOut() == p->getNodeIn())) {
-              p->getFeedingVessels()[npore->getId()] = abs(npore->getFlow());
-              totalInflow += abs(npore->getFlow());
-            }
-          }
-        }
-        p->setInflowShare(abs(p->getFlow()) / totalInflow);
-      }
-    }
-  }
-
   vector<double> blockConcentration;
-  vector<double> poreConcentration;
-
   if (updateBlockAttributes) blockConcentration.reserve(totalBlocks);
-  poreConcentration.reserve(totalPores);
 
-  if (updateBlockAttributes)
+  vector<double> blockValues(totalBlocks), poreValues(totalPores, 0);
+  vector<double> blockSources, poreSources;
+  for (int i = 0; i < totalBlocks; ++i)
+    blockValues[i] = getBlock(i)->getHDConcentration();
+  for (int i = 0; i < poresNumber; ++i)
+    poreValues[a.poreIndex[i]] = a.poreHDConcentration[i];
+  if (updateBlockAttributes) exchange.blockSources(poreValues, blockSources);
+  exchange.poreSources(blockValues, poreSources);
+
+  if (updateBlockAttributes) {
+    prepareTissueStencil();
+    setTissueStencilStep(deltaT);
+    diffusionStencil& stencil = *tissueStencil;
     for (int i = 0; i < totalBlocks; ++i) {
       block* n = getBlock(i);
-      if (!n->getClosed()) {
-        double ii = n->getX();
-        double jj = n->getY();
-        double kk = n->getZ();
-
-        block *nW, *nE, *nN, *nS, *nU, *nD;
-        nW = getBlock(ii - 1, jj, kk);
-        nE = getBlock(ii + 1, jj, kk);
-        nS = getBlock(ii, jj - 1, kk);
-        nN = getBlock(ii, jj + 1, kk);
-        nD = getBlock(ii, jj, kk - 1);
-        nU = getBlock(ii, jj, kk + 1);
-
-        double sumSource = 0;
-        double sumSource2 = 0;
-
-        map<int, double>& neigh = n->neighbooringVesselsArea();
-        for (auto iterator : neigh) {
-          int poreID = iterator.first;
-          pore* pp = getPore(poreID - 1);
-          if (!pp->getClosed()) {
-            double area = iterator.second;
-            sumSource +=
-                pp->getMembranePermeability() * area / (n->getVolume());
-            sumSource2 += pp->getHDConcentration() *
-                          pp->getMembranePermeability() * area /
-                          (n->getVolume());
-          }
-        }
-
-        double newConcentration(0);
-
-        newConcentration += n->getHDConcentration() *
-                            (1 - deltaT * (2 * n->getDiffusivity() * coeff +
-                                           sumSource + sigma));
-        if (nW != 0)
-          if (!nW->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * nW->getHDConcentration();
-        if (nE != 0)
-          if (!nE->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * nE->getHDConcentration();
-        if (nS != 0)
-          if (!nS->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * nS->getHDConcentration();
-        if (nN != 0)
-          if (!nN->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * nN->getHDConcentration();
-        if (nD != 0)
-          if (!nD->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * nD->getHDConcentration();
-        if (nU != 0)
-          if (!nU->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * nU->getHDConcentration();
-
-        if (closedBoundaries) {
-          if (nW == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * n->getHDConcentration();
-          if (nE == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * n->getHDConcentration();
-          if (nS == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * n->getHDConcentration();
-          if (nN == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * n->getHDConcentration();
-          if (nD == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * n->getHDConcentration();
-          if (nU == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * n->getHDConcentration();
-        }
-
-        newConcentration += deltaT * sumSource2;
-
-        blockConcentration.push_back(newConcentration);
-      }
+      int c = stencil.cells[i];
+      stencil.values[c] = n->getClosed() ? 0 : n->getHDConcentration();
+      stencil.source[c] = deltaT * blockSources[i] / n->getVolume();
     }
+    stencil.fillBoundaries(closedBoundaries);
+    stencil.apply();
+    for (int i = 0; i < totalBlocks; ++i)
+      if (!getBlock(i)->getClosed())
+        blockConcentration.push_back(stencil.result[stencil.cells[i]]);
+  }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      double sumSource = 0;
-      double sumSource2 = 0;
-      double sumInflow = 0;
-
-      auto& neigh = p->neighbooringBlocksArea();
-      for (auto iterator : neigh) {
-        int blockID = iterator.first;
-        block* bb = getBlock(blockID - 1);
-        if (!bb->getClosed()) {
-          double area = iterator.second;
-          sumSource += p->getMembranePermeability() * area / (p->getVolume());
-          sumSource2 += bb->getHDConcentration() *
-                        p->getMembranePermeability() * area / (p->getVolume());
-        }
-      }
-
-      if (p->getInlet()) {
-        double concentration = 1;
-        sumInflow = concentration * abs(p->getFlow()) / p->getVolume();
-      } else {
-        auto& neighPores = p->getFeedingVessels();
-        for (auto iterator : neighPores) {
-          pore* pp = getPore(iterator.first - 1);
-          double inflow = iterator.second;
-          if (!pp->getClosed()) {
-            sumInflow += pp->getHDConcentration() * p->getFQE() * inflow /
-                         p->getVolume();
-          }
-        }
+  vector<double> poreConcentration(poresNumber);
+  for (int i = 0; i < poresNumber; ++i) {
+    int index = a.poreIndex[i];
+    double sumSource = exchange.poreExchange[index] / a.poreVolume[i];
+    double sumSource2 = poreSources[index] / a.poreVolume[i];
+    double sumInflow = 0;
+
+    if (a.poreInlet[i]) {
+      double concentration = 1;
+      sumInflow = concentration * abs(a.poreFlow[i]) / a.poreVolume[i];
+    } else {
+      for (int j = a.feedingOffsets[i]; j < a.feedingOffsets[i + 1]; ++j) {
+        int q = a.feedingPores[j];
+        sumInflow += a.poreHDConcentration[q] * a.poreInflowShare[i] *
+                     a.feedingInflows[j] / a.poreVolume[i];
       }
+    }
 
-      double newConcentration(0);
-      newConcentration +=
-          p->getHDConcentration() *
-          (1 - deltaT * (abs(p->getFlow()) / p->getVolume() + sumSource));
-      newConcentration += deltaT * sumInflow;
-      newConcentration += deltaT * sumSource2;
+    double newConcentration(0);
+    newConcentration +=
+        a.poreHDConcentration[i] *
+        (1 - deltaT * (abs(a.poreFlow[i]) / a.poreVolume[i] + sumSource));
+    newConcentration += deltaT * sumInflow;
+    newConcentration += deltaT * sumSource2;
 
-      poreConcentration.push_back(newConcentration);
-    }
+    poreConcentration[i] = newConcentration;
   }
 
   unsigned j(0);
@@ -532,38 +257,28 @@ double network::runHaematocritFlowWithPhaseSeparation() {
       }
     }
 
-  j = 0;
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      p->setHDConcentration(poreConcentration[j]);
-      j++;
-      if (poreConcentration[i] > 1) p->setHDConcentration(1);
-      if (p->getHDConcentration() < 0 || p->getHDConcentration() > 1.001) {
-        cout << "pore concentration out of range: " << p->getHDConcentration()
-             << endl;
-        cancel = true;
-      }
+  for (int i = 0; i < poresNumber; ++i) {
+    double newConcentration = poreConcentration[i];
+    if (newConcentration > 1) newConcentration = 1;
+    a.poreHDConcentration[i] = newConcentration;
+    if (newConcentration < 0 || newConcentration > 1.001) {
+      cout << "pore concentration out of range: " << newConcentration << endl;
+      cancel = true;
     }
   }
 
-  for (int i = 0; i < totalNodes; ++i) {
-    node* n = getNode(i);
-    if (!n->getClosed()) {
-      double concentration(0);
-      double neighboorsNumber(0);
-      vector<int> connectedPores = n->getConnectedPores();
-      for (unsigned j = 0; j < connectedPores.size(); j++) {
-        pore* npore = getPore(connectedPores[j] - 1);
-        if (!npore->getClosed()) {
-          concentration += npore->getHDConcentration();
-          neighboorsNumber++;
-        }
-      }
-      n->setHDConcentration(concentration / neighboorsNumber);
+  const networkGraph& graph = a.nodePores;
+  for (int i = 0; i < a.getNodesNumber(); ++i) {
+    double concentration(0);
+    double neighboorsNumber(0);
+    for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j) {
+      concentration += a.poreHDConcentration[graph.pores[j]];
+      neighboorsNumber++;
     }
+    a.nodeHDConcentration[i] = concentration / neighboorsNumber;
   }
 
+  scatterHaematocrit();
   emitPlotSignal();
 
   return flowTimeStep * flowRate;
@@ -612,6 +327,8 @@ void network::assignBloodViscosities() {
 }
 
 void network::calculateConvectedStimuli() {
+  updateNetworkGraph();
+
   double nutrientRef = QHDref * 0.45;
 
   for (int j = 0; j < totalPores; ++j) {
@@ -643,6 +360,8 @@ void network::calculateConvectedStimuli() {
 }
 
 void network::calculateConductedStimuli() {
+  updateNetworkGraph();
+
   for (int j = 0; j < totalPores; ++j) {
     pore* p = getPore(j);
     if (!p->getClosed()) p->setConductedStim(0);
@@ -672,12 +391,13 @@ void network::calculateConductedStimuli() {
 }
 
 void network::computeConvectiveStimuliRecursive(node* n, double stimulus) {
-  vector<int>& connectedPores = n->getConnectedPores();
-  for (unsigned j = 0; j < connectedPores.size(); ++j) {
-    pore* pp = getPore(connectedPores[j] - 1);
+  const networkGraph& graph = *nodePores;
+  int row = n->getId() - 1;
+  for (int j = graph.offsets[row]; j < graph.offsets[row + 1]; ++j) {
+    pore* pp = getPore(graph.pores[j]);
     if (!pp->getClosed() && !pp->getVisited()) {
-      if ((pp->getNodeOut() == n && pp->getFlow() > 1e-20) ||
-          (pp->getNodeIn() == n && pp->getFlow() < -1e-20)) {
+      // pores leaving the node
+      if (graph.signs[j] * pp->getFlow() < -1e-20) {
         double newAddedStimulus =
             abs(pp->getFlow()) / n->getFlow() * stimulus * exp(-decayConv);
 
@@ -694,12 +414,13 @@ void network::computeConvectiveStimuliRecursive(node* n, double stimulus) {
 }
 
 void network::computeConductiveStimuliRecursive(node* n, double stimulus) {
-  vector<int>& connectedPores = n->getConnectedPores();
-  for (unsigned j = 0; j < connectedPores.size(); ++j) {
-    pore* pp = getPore(connectedPores[j] - 1);
+  const networkGraph& graph = *nodePores;
+  int row = n->getId() - 1;
+  for (int j = graph.offsets[row]; j < graph.offsets[row + 1]; ++j) {
+    pore* pp = getPore(graph.pores[j]);
     if (!pp->getClosed() && !pp->getVisited()) {
-      if ((pp->getNodeIn() == n && pp->getFlow() > 1e-20) ||
-          (pp->getNodeOut() == n && pp->getFlow() < -1e-20)) {
+      // pores entering the node
+      if (graph.signs[j] * pp->getFlow() > 1e-20) {
         double newAddedStimulus = 1. / double(n->getFeedingVesselsNumber()) *
                                   stimulus * exp(-decayCond);
         pp->setConductedStim(pp->getConductedStim() + newAddedStimulus);
@@ -720,34 +441,12 @@ bool network::solvePressureInAngioModel() {
   assignConductivities();
 
   // set constant flow rate
-  double Q1(0), Q2(0), A, B;
-
-  pressureIn = 1;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q1 = getOutletFlow();
-
-  pressureIn = 2;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q2 = getOutletFlow();
-
-  B = (Q1 - Q2 * 1 / 2) / (1 - 1 / 2);
-  A = (Q1 - B);
-
   bool remodel = false;
   double oldDelta = deltaP;
-  deltaP = flowRate / A - B / A;
+  solveForFlowRate(flowRate);
 
   if (abs(deltaP - oldDelta) > 0.1) remodel = true;
 
-  pressureIn = deltaP;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (!n->getClosed()) {
@@ -802,29 +501,7 @@ bool network::solvePressureInAngioModelWthPhaseSeparation() {
     stillMorePoresToClose = false;
 
     // set constant flow rate
-    double Q1(0), Q2(0), A, B;
-
-    pressureIn = 1;
-    pressureOut = 0;
-    solvePressures();
-    updateFlows();
-    Q1 = getOutletFlow();
-
-    pressureIn = 2;
-    pressureOut = 0;
-    solvePressures();
-    updateFlows();
-    Q2 = getOutletFlow();
-
-    B = (Q1 - Q2 * 1 / 2) / (1 - 1 / 2);
-    A = (Q1 - B);
-
-    deltaP = flowRate / A - B / A;
-
-    pressureIn = deltaP;
-    pressureOut = 0;
-    solvePressures();
-    updateFlows();
+    solveForFlowRate(flowRate);
 
     for (int i = 0; i < totalNodes; ++i) {
       node* n = getNode(i);
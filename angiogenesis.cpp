@@ -6,6 +6,9 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "diffusionstencil.h"
+#include "networkgraph.h"
+#include "pressuresolver.h"
 #include "tools.h"
 
 using namespace std;
@@ -69,6 +72,9 @@ void network::runAngiogenesisOnLattice() {
   }
 
   cout << "Simulation Time " << timeSoFar << endl;
+  cout << "Pressure solver factorizations: "
+       << pressureSystem->getFactorizations()
+       << " low-rank updates: " << pressureSystem->getUpdates() << endl;
 
   endTime = tools::getCPUTime();
   cout << "Processing Time: " << endTime - startTime << " s" << endl;
@@ -174,6 +180,10 @@ void network::updateChemicalConcentrations() {
           1 / angio_Beta) /
       2;
 
+  prepareTissueStencil();
+  diffusionStencil &stencil = *tissueStencil;
+  stencil.setCoefficients(1, 1, Nz >= 5 ? 1 : 0);
+
   double timeSoFar(0);
   while (timeSoFar < timeStep) {
     timeSoFar += subTimeStep;
@@ -193,18 +203,17 @@ void network::updateChemicalConcentrations() {
     // update TAF, FN, MDE (maps)
     for (int i = 0; i < totalBlocks; ++i) {
       block *n = getBlock(i);
+      int c = stencil.cells[i];
+      stencil.values[c] = n->getMDEConcentration();
+      stencil.diagonal[c] = coeff2;
+      stencil.weight[c] = coeff3;
+      stencil.source[c] = 0;
       if (!n->getClosed()) {
-        double ii = n->getX();
-        double jj = n->getY();
-        double kk = n->getZ();
-
         double endothelialDensity = 0;
 
-        node *s = getNode(ii, jj, kk);
+        node *s = getNode(n->getX(), n->getY(), n->getZ());
         if (s != 0 && s->getSprouTip()) endothelialDensity = 1;
 
-        double MDEconcentration = 0;
-
         if (endothelialDensity == 1) {
           blockTAFConcentration.push_back(n->getTAFConcentration() *
                                           (1 - subTimeStep * angio_Eta));
@@ -212,41 +221,19 @@ void network::updateChemicalConcentrations() {
               n->getFNConcentration() *
                   (1 - subTimeStep * angio_Gamma * n->getMDEConcentration()) +
               subTimeStep * angio_Beta);
-          MDEconcentration = coeff1;
+          stencil.source[c] = coeff1;
         }
-
-        MDEconcentration += n->getMDEConcentration() * coeff2;
-
-        block *nW, *nE, *nN, *nS, *nU, *nD;
-        nW = getBlock(ii - 1, jj, kk);
-        nE = getBlock(ii + 1, jj, kk);
-        nS = getBlock(ii, jj - 1, kk);
-        nN = getBlock(ii, jj + 1, kk);
-        nD = getBlock(ii, jj, kk - 1);
-        nU = getBlock(ii, jj, kk + 1);
-
-        if (nW != 0) MDEconcentration += coeff3 * nW->getMDEConcentration();
-        if (nE != 0) MDEconcentration += coeff3 * nE->getMDEConcentration();
-        if (nS != 0) MDEconcentration += coeff3 * nS->getMDEConcentration();
-        if (nN != 0) MDEconcentration += coeff3 * nN->getMDEConcentration();
-        if (Nz >= 5)
-          if (nD != 0) MDEconcentration += coeff3 * nD->getMDEConcentration();
-        if (Nz >= 5)
-          if (nU != 0) MDEconcentration += coeff3 * nU->getMDEConcentration();
-
-        if (nW == 0) MDEconcentration += coeff3 * n->getMDEConcentration();
-        if (nE == 0) MDEconcentration += coeff3 * n->getMDEConcentration();
-        if (nS == 0) MDEconcentration += coeff3 * n->getMDEConcentration();
-        if (nN == 0) MDEconcentration += coeff3 * n->getMDEConcentration();
-        if (Nz >= 5)
-          if (nD == 0) MDEconcentration += coeff3 * n->getMDEConcentration();
-        if (Nz >= 5)
-          if (nU == 0) MDEconcentration += coeff3 * n->getMDEConcentration();
-
-        blockMDEConcentration.push_back(MDEconcentration);
       }
     }
 
+    // no flux through the lattice boundaries, no diffusion along z on thin
+    // lattices
+    stencil.fillBoundaries(true);
+    stencil.apply();
+    for (int i = 0; i < totalBlocks; ++i)
+      if (!getBlock(i)->getClosed())
+        blockMDEConcentration.push_back(stencil.result[stencil.cells[i]]);
+
     unsigned j(0);
     for (int i = 0; i < totalBlocks; ++i) {
       block *n = getBlock(i);
@@ -888,12 +875,19 @@ void network::remodelVasculature() {
   double PVsInjectedSoFar(0);
   double dampingFactor(1);  // used to help radii adaptation converge
 
+  // exchange coefficients of the vessels grown since the last remodelling
+  buildTissueCoupling();
+
   // solve pressure in vasculature
   phaseSeparation ? solvePressureInAngioModelWthPhaseSeparation()
                   : solvePressureInAngioModel();
+  if (solverChoice > 1)
+    cout << "Pressure solver iterations: " << getSolverIterations()
+         << " residual: " << getSolverError() << endl;
 
   while (unstablePressureField) {
     double volumeInjectedSoFar = 0;
+    gatherHaematocritArrays();
     while (volumeInjectedSoFar / totalPoresVolume <
            1)  // inject 2 PV before recalculating radii
     {
@@ -924,6 +918,9 @@ void network::remodelVasculature() {
     unstablePressureField = phaseSeparation
                                 ? solvePressureInAngioModelWthPhaseSeparation()
                                 : solvePressureInAngioModel();
+    if (solverChoice > 1)
+      cout << "Pressure solver iterations: " << getSolverIterations()
+           << " residual: " << getSolverError() << endl;
 
     // A safety control to prevent non-convergence
     if (PVsInjectedSoFar > 50) break;
@@ -1003,14 +1000,15 @@ std::vector<double> network::generateEndothelialCellProbabilities(node *no) {
   double jj = no->getIndexY();
   double kk = no->getIndexZ();
 
-  block *n = getBlock((ii, jj, kk));
+  int cell = tableOfBlocks.index(ii, jj, kk);
+  block *n = tableOfBlocks[cell];
   block *nW, *nE, *nN, *nS, *nU, *nD;
-  nW = getBlock(ii - 1, jj, kk);
-  nE = getBlock(ii + 1, jj, kk);
-  nS = getBlock(ii, jj - 1, kk);
-  nN = getBlock(ii, jj + 1, kk);
-  nD = getBlock(ii, jj, kk - 1);
-  nU = getBlock(ii, jj, kk + 1);
+  nW = tableOfBlocks[cell - tableOfBlocks.getStrideX()];
+  nE = tableOfBlocks[cell + tableOfBlocks.getStrideX()];
+  nS = tableOfBlocks[cell - tableOfBlocks.getStrideY()];
+  nN = tableOfBlocks[cell + tableOfBlocks.getStrideY()];
+  nD = tableOfBlocks[cell - 1];
+  nU = tableOfBlocks[cell + 1];
 
   double dimensionPreFactor = Nz < 5 ? 4 : 6;
   vector<double> probabilities;
@@ -1156,7 +1154,7 @@ std::vector<double> network::generateEndothelialCellProbabilities(node *no) {
 }
 
 node *network::addNode(node *source, int i, int j, int k) {
-  node *n = new node(i, j, k);
+  node *n = new (nodeArena) node(i, j, k);
   n->setId(totalNodes + 1);
   n->setXCoordinate(n->getIndexX() * length);
   n->setYCoordinate(n->getIndexY() * length);
@@ -1172,9 +1170,10 @@ node *network::addNode(node *source, int i, int j, int k) {
                       length * degreeOfDistortion * (-1 + 2 * uniform_real()));
 
   tableOfAllNodes.push_back(n);
-  tableOfNodes[i][j][k] = n;
+  tableOfNodes(i, j, k) = n;
   totalNodes++;
   totalOpenedNodes++;
+  networkGraphOutdated = true;
 
   // set neighbours
   n->getNeighboors().push_back(source->getId());
@@ -1187,28 +1186,30 @@ node *network::addNode(node *source, int i, int j, int k) {
 }
 
 pore *network::addVessel(node *nodeIn, node *nodeOut, int i) {
-  pore *p = new pore(nodeIn, nodeOut);
+  pore *p = new (poreArena) pore(nodeIn, nodeOut);
   tableOfAllPores.push_back(p);
   p->setId(totalPores + 1);
   totalPores++;
   totalOpenedPores++;
 
   if (i == 1)  // X pore
-    tableOfPoresX[nodeIn->getIndexX()][nodeIn->getIndexY()]
-                 [nodeIn->getIndexZ()] = p;
+    tableOfPoresX(nodeIn->getIndexX(), nodeIn->getIndexY(),
+                  nodeIn->getIndexZ()) = p;
 
   if (i == 2)  // Y pore
-    tableOfPoresY[nodeIn->getIndexX()][nodeIn->getIndexY()]
-                 [nodeIn->getIndexZ()] = p;
+    tableOfPoresY(nodeIn->getIndexX(), nodeIn->getIndexY(),
+                  nodeIn->getIndexZ()) = p;
 
   if (i == 3)  // Z pore
-    tableOfPoresZ[nodeIn->getIndexX()][nodeIn->getIndexY()]
-                 [nodeIn->getIndexZ()] = p;
+    tableOfPoresZ(nodeIn->getIndexX(), nodeIn->getIndexY(),
+                  nodeIn->getIndexZ()) = p;
 
   double averageRadius(0);
+  int neighboorsNumber(0);
   // set neighboors
   nodeIn->getConnectedPores().push_back(p->getId());
   nodeOut->getConnectedPores().push_back(p->getId());
+  networkGraphOutdated = true;
 
   if (find(nodeIn->getNeighboors().begin(), nodeIn->getNeighboors().end(),
            nodeOut->getId()) == nodeIn->getNeighboors().end())
@@ -1220,22 +1221,20 @@ pore *network::addVessel(node *nodeIn, node *nodeOut, int i) {
   for (int i = 0; i < nodeIn->getConnectedPores().size(); ++i) {
     pore *pp = getPore(nodeIn->getConnectedPores()[i] - 1);
     if (pp != p) {
-      p->getNeighboors().push_back(pp);
-      pp->getNeighboors().push_back(p);
       averageRadius += pp->getRadius();
+      neighboorsNumber++;
     }
   }
 
   for (int i = 0; i < nodeOut->getConnectedPores().size(); ++i) {
     pore *pp = getPore(nodeOut->getConnectedPores()[i] - 1);
     if (pp != p) {
-      p->getNeighboors().push_back(pp);
-      pp->getNeighboors().push_back(p);
       averageRadius += pp->getRadius();
+      neighboorsNumber++;
     }
   }
 
-  averageRadius /= double(p->getNeighboors().size());
+  averageRadius /= double(neighboorsNumber);
 
   p->setRadius(min(6e-6, averageRadius));
 
@@ -46,8 +46,8 @@ void network::buildArtificialNetwork() {
   double xcoordinates[] = {200, 170, 120, 80, 50,  25,  10,
                            10,  25,  50,  80, 120, 170, 200};
 
-  tableOfAllNodes[0] = new node(-200e-6, 0, 0);
-  tableOfAllNodes[1] = new node(0, 0, 0);
+  tableOfAllNodes[0] = new (nodeArena) node(-200e-6, 0, 0);
+  tableOfAllNodes[1] = new (nodeArena) node(0, 0, 0);
 
   double abscisse = 0;
   int index = 1;
@@ -61,7 +61,7 @@ void network::buildArtificialNetwork() {
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<<nodeNumber<<" "<<abscisse<<" "<<y<<endl;
       nodeNumber++;
     }
@@ -75,7 +75,7 @@ void network::buildArtificialNetwork() {
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(rabscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse, y, 0);
       // cout<<nodeNumber<<" "<<abscisse<<" "<<y<<endl;
       nodeNumber++;
     }
@@ -92,14 +92,15 @@ void network::buildArtificialNetwork() {
       double y = -(yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) +
                  2 * (yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) * j /
                      (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(rabscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse, y, 0);
       // cout<<nodeNumber<<" "<<abscisse<<" "<<y<<endl;
       nodeNumber++;
     }
   }
 
-  tableOfAllNodes[nodeNumber] = new node(rabscisse + 200e-6, 0, 0);
-  tableOfAllNodes[nodeNumber + 1] = new node(rabscisse + 400e-6, 0, 0);
+  tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse + 200e-6, 0, 0);
+  tableOfAllNodes[nodeNumber + 1] =
+      new (nodeArena) node(rabscisse + 400e-6, 0, 0);
 
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
@@ -118,7 +119,7 @@ void network::buildArtificialNetwork() {
   totalOpenedPores = totalPores = 510 + 25 * 128 + 127 * 26;
   tableOfAllPores.resize(totalPores);
 
-  tableOfAllPores[0] = new pore(getNode(1), getNode(0));
+  tableOfAllPores[0] = new (poreArena) pore(getNode(1), getNode(0));
 
   nodeNumber = 1;
   int poreNumber = 1;
@@ -130,10 +131,10 @@ void network::buildArtificialNetwork() {
       node* nodeOut1 = getNode(2 * nodeNumber);
       node* nodeOut2 = getNode(2 * nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<poreNumber<<" "<<nodeNumber<<" "<<2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       //   cout<<poreNumber<<" "<<nodeNumber<<" "<<2*nodeNumber+1<<endl;
       poreNumber++;
       nodeNumber++;
@@ -148,7 +149,7 @@ void network::buildArtificialNetwork() {
       node* nodeIn = getNode(nodeNumber);
       node* nodeOut = getNode(nodeNumber + 128);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
       // cout<<poreNumber<<" "<<nodeNumber<<" "<<2*nodeNumber<<endl;
       poreNumber++;
       // cout<<nodeNumber<<" "<<abscisse<<" "<<y<<endl;
@@ -163,7 +164,7 @@ void network::buildArtificialNetwork() {
       node* nodeIn = getNode(nodeNumber);
       node* nodeOut = getNode(nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
       // cout<<poreNumber<<" "<<nodeNumber<<" "<<2*nodeNumber<<endl;
       poreNumber++;
       // cout<<nodeNumber<<" "<<abscisse<<" "<<y<<endl;
@@ -181,11 +182,11 @@ void network::buildArtificialNetwork() {
       node* nodeOut1 = getNode(totalNodes - 1 - 2 * nodeNumber);
       node* nodeOut2 = getNode(totalNodes - 1 - 2 * nodeNumber - 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       // "<<totalNodes-1-2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       //  "<<totalNodes-1-2*nodeNumber-1<<endl;
       poreNumber++;
@@ -195,7 +196,7 @@ void network::buildArtificialNetwork() {
   }
 
   tableOfAllPores[totalPores - 1] =
-      new pore(getNode(totalNodes - 1), getNode(totalNodes - 2));
+      new (poreArena) pore(getNode(totalNodes - 1), getNode(totalNodes - 2));
 
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -213,8 +214,6 @@ void network::buildArtificialNetwork() {
 
   cout << "Setting neighboors..." << endl;
 
-  // setting neighboors
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     int connectionNumber(0);
@@ -240,25 +239,6 @@ void network::buildArtificialNetwork() {
       maxConnectionNumber = connectionNumber;
   }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (n->getId() == 1) {
@@ -430,7 +410,7 @@ void network::buildArtificialNetwork2() {
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       n->setId(nodeNumber + 1);
@@ -454,7 +434,7 @@ void network::buildArtificialNetwork2() {
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       n->setId(nodeNumber + 1);
@@ -477,7 +457,7 @@ void network::buildArtificialNetwork2() {
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       n->setId(nodeNumber + 1);
@@ -500,7 +480,7 @@ void network::buildArtificialNetwork2() {
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       n->setId(nodeNumber + 1);
@@ -523,7 +503,7 @@ void network::buildArtificialNetwork2() {
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       if (i == Nx - 1) n->setOutlet(true);
@@ -566,7 +546,7 @@ void network::buildArtificialNetwork2() {
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -583,7 +563,7 @@ void network::buildArtificialNetwork2() {
       {
         node* nodeOut = 0;
         node* nodeIn = getNode(nodeNumber);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -598,7 +578,7 @@ void network::buildArtificialNetwork2() {
         node* nodeOut = getNode(nodeNumber);
         double number = nodesSoFar + j * 2;
         node* nodeIn = getNode(number);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -614,7 +594,7 @@ void network::buildArtificialNetwork2() {
       if (i == 0) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -643,7 +623,7 @@ void network::buildArtificialNetwork2() {
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(250e-6);
@@ -660,7 +640,7 @@ void network::buildArtificialNetwork2() {
         node* nodeOut = getNode(nodeNumber);
         double number = nodesSoFar + j * 5;
         node* nodeIn = getNode(number);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(250e-6);
@@ -674,7 +654,7 @@ void network::buildArtificialNetwork2() {
       } else {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(250e-6);
@@ -702,7 +682,7 @@ void network::buildArtificialNetwork2() {
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(100e-6);
@@ -719,7 +699,7 @@ void network::buildArtificialNetwork2() {
         node* nodeOut = getNode(nodeNumber);
         double number = nodesSoFar + j * 4;
         node* nodeIn = getNode(number);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(100e-6);
@@ -733,7 +713,7 @@ void network::buildArtificialNetwork2() {
       } else {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(100e-6);
@@ -762,7 +742,7 @@ void network::buildArtificialNetwork2() {
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(20e-6);
@@ -779,7 +759,7 @@ void network::buildArtificialNetwork2() {
         node* nodeOut = getNode(nodeNumber);
         double number = nodesSoFar + j * 2;
         node* nodeIn = getNode(number);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(20e-6);
@@ -793,7 +773,7 @@ void network::buildArtificialNetwork2() {
       } else {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(20e-6);
@@ -822,7 +802,7 @@ void network::buildArtificialNetwork2() {
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(10e-6);
@@ -839,7 +819,7 @@ void network::buildArtificialNetwork2() {
       {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = 0;
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(10e-6);
@@ -852,7 +832,7 @@ void network::buildArtificialNetwork2() {
       } else {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(10e-6);
@@ -869,29 +849,6 @@ void network::buildArtificialNetwork2() {
     }
   }
 
-  cout << "Setting neighboors..." << endl;
-
-  // setting neighboors
-
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   cout << "Create Distortion..." << endl;
 
   length = 50e-6;
@@ -1044,8 +1001,8 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
 
   double xcoordinates[] = {200, 170, 100, 20, 20, 100, 170, 200};
 
-  tableOfAllNodes[0] = new node(-200e-6, 0, 0);
-  tableOfAllNodes[1] = new node(0, 0, 0);
+  tableOfAllNodes[0] = new (nodeArena) node(-200e-6, 0, 0);
+  tableOfAllNodes[1] = new (nodeArena) node(0, 0, 0);
 
   double abscisse = 0;
   int index = 1;
@@ -1059,7 +1016,7 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
@@ -1075,7 +1032,7 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(rabscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
@@ -1093,15 +1050,16 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
       double y = -(yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) +
                  2 * (yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) * j /
                      (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(rabscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
     }
   }
 
-  tableOfAllNodes[nodeNumber] = new node(rabscisse + 200e-6, 0, 0);
-  tableOfAllNodes[nodeNumber + 1] = new node(rabscisse + 400e-6, 0, 0);
+  tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse + 200e-6, 0, 0);
+  tableOfAllNodes[nodeNumber + 1] =
+      new (nodeArena) node(rabscisse + 400e-6, 0, 0);
 
   cout << "nodeNumber:" << nodeNumber << " "
        << "totalNodes:" << totalNodes << endl;
@@ -1122,7 +1080,7 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
   totalOpenedPores = totalPores = 122 + 25 * 81 + 26 * 81 + 14;
   tableOfAllPores.resize(totalPores);
 
-  tableOfAllPores[0] = new pore(getNode(0), getNode(1));
+  tableOfAllPores[0] = new (poreArena) pore(getNode(0), getNode(1));
 
   nodeNumber = 1;
   int poreNumber = 1;
@@ -1135,15 +1093,15 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
       node* nodeOut2 = getNode(3 * nodeNumber);
       node* nodeOut3 = getNode(3 * nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber+1:"<< 2*nodeNumber+1<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut3);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut3);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
@@ -1161,7 +1119,7 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
       node* nodeIn = getNode(nodeNumber);
       node* nodeOut = getNode(nodeNumber + 81);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"nodeNumber+128: "<< nodeNumber+128<<endl;
       poreNumber++;
@@ -1178,7 +1136,7 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
       node* nodeIn = getNode(nodeNumber);
       node* nodeOut = getNode(nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
       // cout<<"poreNumber:"<<poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*nodeNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
@@ -1199,15 +1157,15 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
       node* nodeOut2 = getNode(totalNodes - 1 - 3 * nodeNumber);
       node* nodeOut3 = getNode(totalNodes - 1 - 3 * nodeNumber - 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       // "<<totalNodes-1-2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       //  "<<totalNodes-1-2*nodeNumber-1<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut3);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut3);
       //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       //  "<<totalNodes-1-2*nodeNumber-1<<endl;
       poreNumber++;
@@ -1227,13 +1185,13 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
            node* nodeOut2=getNode(totalNodes-1-3*nodeNumber);
            node* nodeOut3=getNode(totalNodes-1-3*nodeNumber-1);
 
-           tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut1);
+           tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut1);
           // cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
    "<<totalNodes-1-2*nodeNumber<<endl; poreNumber++;
-           tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut2);
+           tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut2);
          //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
    "<<totalNodes-1-2*nodeNumber-1<<endl; poreNumber++;
-           tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut3);
+           tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut3);
          //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
    "<<totalNodes-1-2*nodeNumber-1<<endl; poreNumber++; nodeNumber++;
        }
@@ -1246,12 +1204,12 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
   node* nodeOut2=getNode(totalNodes-1-3*nodeNumber);
   node* nodeOut3=getNode(totalNodes-1-3*nodeNumber-1);
 
-  tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut1);
-  tableOfAllPores[poreNumber+1]=new pore(nodeIn,nodeOut2);
-  tableOfAllPores[poreNumber+2]=new pore(nodeIn,nodeOut3);*/
+  tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut1);
+  tableOfAllPores[poreNumber+1]=new (poreArena) pore(nodeIn,nodeOut2);
+  tableOfAllPores[poreNumber+2]=new (poreArena) pore(nodeIn,nodeOut3);*/
 
   tableOfAllPores[totalPores - 1] =
-      new pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
+      new (poreArena) pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
 
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -1268,8 +1226,6 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
   minRadius = 4e-6;
   cout << "Setting neighboors..." << endl;
 
-  // setting neighboors
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     int connectionNumber(0);
@@ -1295,25 +1251,6 @@ void network::buildArtificialNetwork3()  // branches in 3^n + rectangular part
       maxConnectionNumber = connectionNumber;
   }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (n->getId() == 1) {
@@ -1477,8 +1414,8 @@ void network::buildArtificialNetwork4()  // branches in 2^n
   double xcoordinates[] = {200, 170, 120, 80, 50,  25,  10,
                            10,  25,  50,  80, 120, 170, 10};
 
-  tableOfAllNodes[0] = new node(-200e-6, 0, 0);
-  tableOfAllNodes[1] = new node(0, 0, 0);
+  tableOfAllNodes[0] = new (nodeArena) node(-200e-6, 0, 0);
+  tableOfAllNodes[1] = new (nodeArena) node(0, 0, 0);
 
   double abscisse = 0;
   int index = 1;
@@ -1492,7 +1429,7 @@ void network::buildArtificialNetwork4()  // branches in 2^n
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
@@ -1510,7 +1447,7 @@ void network::buildArtificialNetwork4()  // branches in 2^n
       {
           double
   y=-(abscisse/L)*yEdgeLength/2.+j*(abscisse/L*yEdgeLength)/(index-1);
-          tableOfAllNodes[nodeNumber]= new node(rabscisse,y,0);
+          tableOfAllNodes[nodeNumber]= new (nodeArena) node(rabscisse,y,0);
          //cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
   "<<"y:"<< y<<endl; nodeNumber++;
       }
@@ -1526,15 +1463,16 @@ void network::buildArtificialNetwork4()  // branches in 2^n
       double y = -(yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) +
                  2 * (yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) * j /
                      (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
     }
   }
 
-  tableOfAllNodes[nodeNumber] = new node(abscisse + 200e-6, 0, 0);
-  tableOfAllNodes[nodeNumber + 1] = new node(abscisse + 400e-6, 0, 0);
+  tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse + 200e-6, 0, 0);
+  tableOfAllNodes[nodeNumber + 1] =
+      new (nodeArena) node(abscisse + 400e-6, 0, 0);
 
   cout << "nodeNumber:" << nodeNumber << " "
        << "totalNodes:" << totalNodes << endl;
@@ -1556,7 +1494,7 @@ void network::buildArtificialNetwork4()  // branches in 2^n
   totalOpenedPores = totalPores = 510;
   tableOfAllPores.resize(totalPores);
 
-  tableOfAllPores[0] = new pore(getNode(0), getNode(1));
+  tableOfAllPores[0] = new (poreArena) pore(getNode(0), getNode(1));
 
   nodeNumber = 1;
   int poreNumber = 1;
@@ -1568,11 +1506,11 @@ void network::buildArtificialNetwork4()  // branches in 2^n
       node* nodeOut1 = getNode(2 * nodeNumber);
       node* nodeOut2 = getNode(2 * nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber+1:"<< 2*nodeNumber+1<<endl;
       poreNumber++;
@@ -1592,7 +1530,7 @@ void network::buildArtificialNetwork4()  // branches in 2^n
           node* nodeIn=getNode(nodeNumber);
           node* nodeOut=getNode(nodeNumber+128);
 
-          tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut);
+          tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut);
           //cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
   "<<"nodeNumber+128: "<< nodeNumber+128<<endl; poreNumber++; nodeNumber++;
       }
@@ -1609,7 +1547,7 @@ void network::buildArtificialNetwork4()  // branches in 2^n
           node* nodeIn=getNode(nodeNumber);
           node* nodeOut=getNode(nodeNumber+1);
 
-          tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut);
+          tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut);
          //cout<<"poreNumber:"<<poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
   "<<"2*nodeNumber:"<< 2*nodeNumber<<endl; poreNumber++;
           //cout<<"nodeNumber:"<< nodeNumber<<" "<<"abscisse:"<< abscisse<<endl;
@@ -1627,11 +1565,11 @@ void network::buildArtificialNetwork4()  // branches in 2^n
       node* nodeIn1 = getNode(totalNodes - 1 - 2 * nodeNumber);
       node* nodeIn2 = getNode(totalNodes - 1 - 2 * nodeNumber - 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn1, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn1, nodeOut);
       // cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       // "<<totalNodes-1-2*nodeNumber<<endl;te
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn2, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn2, nodeOut);
       //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       //  "<<totalNodes-1-2*nodeNumber-1<<endl;
       poreNumber++;
@@ -1641,7 +1579,7 @@ void network::buildArtificialNetwork4()  // branches in 2^n
   }
 
   tableOfAllPores[totalPores - 1] =
-      new pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
+      new (poreArena) pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
 
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -1659,8 +1597,6 @@ void network::buildArtificialNetwork4()  // branches in 2^n
 
   cout << "Setting neighboors..." << endl;
 
-  // setting neighboors
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     int connectionNumber(0);
@@ -1686,25 +1622,6 @@ void network::buildArtificialNetwork4()  // branches in 2^n
       maxConnectionNumber = connectionNumber;
   }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (n->getId() == 1) {
@@ -1868,8 +1785,8 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
 
   double xcoordinates[] = {300, 300, 300, 300};
 
-  tableOfAllNodes[0] = new node(-200e-6, 0, 0);
-  tableOfAllNodes[1] = new node(0, 0, 0);
+  tableOfAllNodes[0] = new (nodeArena) node(-200e-6, 0, 0);
+  tableOfAllNodes[1] = new (nodeArena) node(0, 0, 0);
 
   double abscisse = 0;
   int index = 1;
@@ -1883,7 +1800,7 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
@@ -1901,7 +1818,7 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
        {
            double
    y=-(abscisse/L)*yEdgeLength/2.+j*(abscisse/L*yEdgeLength)/(index-1);
-           tableOfAllNodes[nodeNumber]= new node(rabscisse,y,0);
+           tableOfAllNodes[nodeNumber]= new (nodeArena) node(rabscisse,y,0);
           //cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
    "<<"y:"<< y<<endl; nodeNumber++;
        }
@@ -1917,15 +1834,16 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
       double y = -(yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) +
                  2 * (yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) * j /
                      (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
     }
   }
 
-  tableOfAllNodes[nodeNumber] = new node(abscisse + 200e-6, 0, 0);
-  tableOfAllNodes[nodeNumber + 1] = new node(abscisse + 400e-6, 0, 0);
+  tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse + 200e-6, 0, 0);
+  tableOfAllNodes[nodeNumber + 1] =
+      new (nodeArena) node(abscisse + 400e-6, 0, 0);
 
   cout << "nodeNumber:" << nodeNumber << " "
        << "totalNodes:" << totalNodes << endl;
@@ -1947,7 +1865,7 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
   totalOpenedPores = totalPores = 14;
   tableOfAllPores.resize(totalPores);
 
-  tableOfAllPores[0] = new pore(getNode(0), getNode(1));
+  tableOfAllPores[0] = new (poreArena) pore(getNode(0), getNode(1));
 
   nodeNumber = 1;
   int poreNumber = 1;
@@ -1959,11 +1877,11 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
       node* nodeOut1 = getNode(2 * nodeNumber);
       node* nodeOut2 = getNode(2 * nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber+1:"<< 2*nodeNumber+1<<endl;
       poreNumber++;
@@ -1983,7 +1901,7 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
           node* nodeIn=getNode(nodeNumber);
           node* nodeOut=getNode(nodeNumber+128);
 
-          tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut);
+          tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut);
           //cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
   "<<"nodeNumber+128: "<< nodeNumber+128<<endl; poreNumber++; nodeNumber++;
       }
@@ -2000,7 +1918,7 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
           node* nodeIn=getNode(nodeNumber);
           node* nodeOut=getNode(nodeNumber+1);
 
-          tableOfAllPores[poreNumber]=new pore(nodeIn,nodeOut);
+          tableOfAllPores[poreNumber]=new (poreArena) pore(nodeIn,nodeOut);
          //cout<<"poreNumber:"<<poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
   "<<"2*nodeNumber:"<< 2*nodeNumber<<endl; poreNumber++;
           //cout<<"nodeNumber:"<< nodeNumber<<" "<<"abscisse:"<< abscisse<<endl;
@@ -2019,11 +1937,11 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
       node* nodeIn1 = getNode(totalNodes - 1 - 2 * nodeNumber);
       node* nodeIn2 = getNode(totalNodes - 1 - 2 * nodeNumber - 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn1, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn1, nodeOut);
       // cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       // "<<totalNodes-1-2*nodeNumber<<endl;te
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn2, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn2, nodeOut);
       //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       //  "<<totalNodes-1-2*nodeNumber-1<<endl;
       poreNumber++;
@@ -2033,7 +1951,7 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
   }
 
   tableOfAllPores[totalPores - 1] =
-      new pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
+      new (poreArena) pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
 
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -2051,8 +1969,6 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
 
   cout << "Setting neighboors..." << endl;
 
-  // setting neighboors
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     int connectionNumber(0);
@@ -2078,25 +1994,6 @@ void network::buildArtificialNetwork5()  // small: branches up to 2^2
       maxConnectionNumber = connectionNumber;
   }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (n->getId() == 1) {
@@ -2261,8 +2158,8 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
 
   double xcoordinates[] = {300, 300, 300, 300};
 
-  tableOfAllNodes[0] = new node(-200e-6, 0, 0);
-  tableOfAllNodes[1] = new node(0, 0, 0);
+  tableOfAllNodes[0] = new (nodeArena) node(-200e-6, 0, 0);
+  tableOfAllNodes[1] = new (nodeArena) node(0, 0, 0);
 
   double abscisse = 0;
   int index = 1;
@@ -2276,7 +2173,7 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(abscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(abscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
@@ -2292,7 +2189,7 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
     for (int j = 0; j < index; ++j) {
       double y = -(abscisse / L) * yEdgeLength / 2. +
                  j * (abscisse / L * yEdgeLength) / (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(rabscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
@@ -2310,15 +2207,16 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
       double y = -(yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) +
                  2 * (yEdgeLength - (abscisse / (2 * L)) * yEdgeLength) * j /
                      (index - 1);
-      tableOfAllNodes[nodeNumber] = new node(rabscisse, y, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse, y, 0);
       // cout<< "nodeNumber:"<<nodeNumber<<" "<<"abscisse:"<< abscisse<<"
       // "<<"y:"<< y<<endl;
       nodeNumber++;
     }
   }
 
-  tableOfAllNodes[nodeNumber] = new node(rabscisse + 200e-6, 0, 0);
-  tableOfAllNodes[nodeNumber + 1] = new node(rabscisse + 400e-6, 0, 0);
+  tableOfAllNodes[nodeNumber] = new (nodeArena) node(rabscisse + 200e-6, 0, 0);
+  tableOfAllNodes[nodeNumber + 1] =
+      new (nodeArena) node(rabscisse + 400e-6, 0, 0);
 
   cout << "nodeNumber:" << nodeNumber << " "
        << "totalNodes:" << totalNodes << endl;
@@ -2340,7 +2238,7 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
   totalOpenedPores = totalPores = 14 + 2 * 4 + 2 * 3;
   tableOfAllPores.resize(totalPores);
 
-  tableOfAllPores[0] = new pore(getNode(0), getNode(1));
+  tableOfAllPores[0] = new (poreArena) pore(getNode(0), getNode(1));
 
   nodeNumber = 1;
   int poreNumber = 1;
@@ -2352,11 +2250,11 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
       node* nodeOut1 = getNode(2 * nodeNumber);
       node* nodeOut2 = getNode(2 * nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut1);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut1);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut2);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut2);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*noedNumber+1:"<< 2*nodeNumber+1<<endl;
       poreNumber++;
@@ -2374,7 +2272,7 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
       node* nodeIn = getNode(nodeNumber);
       node* nodeOut = getNode(nodeNumber + 4);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
       // cout<<"poreNumber:"<< poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"nodeNumber+128: "<< nodeNumber+128<<endl;
       poreNumber++;
@@ -2391,7 +2289,7 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
       node* nodeIn = getNode(nodeNumber);
       node* nodeOut = getNode(nodeNumber + 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
       // cout<<"poreNumber:"<<poreNumber<<" "<<"nodeNumber:"<< nodeNumber<<"
       // "<<"2*nodeNumber:"<< 2*nodeNumber<<endl;
       poreNumber++;
@@ -2411,11 +2309,11 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
       node* nodeIn1 = getNode(totalNodes - 1 - 2 * nodeNumber);
       node* nodeIn2 = getNode(totalNodes - 1 - 2 * nodeNumber - 1);
 
-      tableOfAllPores[poreNumber] = new pore(nodeIn1, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn1, nodeOut);
       // cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       // "<<totalNodes-1-2*nodeNumber<<endl;te
       poreNumber++;
-      tableOfAllPores[poreNumber] = new pore(nodeIn2, nodeOut);
+      tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn2, nodeOut);
       //  cout<<poreNumber<<" "<<totalNodes-1-nodeNumber<<"
       //  "<<totalNodes-1-2*nodeNumber-1<<endl;
       poreNumber++;
@@ -2425,7 +2323,7 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
   }
 
   tableOfAllPores[totalPores - 1] =
-      new pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
+      new (poreArena) pore(getNode(totalNodes - 2), getNode(totalNodes - 1));
 
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -2443,8 +2341,6 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
 
   cout << "Setting neighboors..." << endl;
 
-  // setting neighboors
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     int connectionNumber(0);
@@ -2470,25 +2366,6 @@ void network::buildArtificialNetwork6()  // small: branches up to 2^2 +
       maxConnectionNumber = connectionNumber;
   }
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (n->getId() == 1) {
@@ -2661,7 +2538,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       n->setId(nodeNumber + 1);
@@ -2685,7 +2562,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
 
   for (int i = 0; i < Nx; ++i) {
     for (int j = 0; j < Ny; ++j) {
-      tableOfAllNodes[nodeNumber] = new node(i, j, 0);
+      tableOfAllNodes[nodeNumber] = new (nodeArena) node(i, j, 0);
       node* n = tableOfAllNodes[nodeNumber];
 
       if (i == Nx - 1) n->setOutlet(true);
@@ -2725,7 +2602,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -2742,7 +2619,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
       {
         node* nodeOut = 0;
         node* nodeIn = getNode(nodeNumber);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -2757,7 +2634,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
         node* nodeOut = getNode(nodeNumber);
         double number = nodesSoFar + j * 2;
         node* nodeIn = getNode(number);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -2773,7 +2650,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
       if (i == 0) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(500e-6);
@@ -2802,7 +2679,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
       if (j != Ny - 1) {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + 1);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(250e-6);
@@ -2819,7 +2696,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
       {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = 0;
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(250e-6);
@@ -2832,7 +2709,7 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
       } else {
         node* nodeOut = getNode(nodeNumber);
         node* nodeIn = getNode(nodeNumber + Ny);
-        tableOfAllPores[poreNumber] = new pore(nodeIn, nodeOut);
+        tableOfAllPores[poreNumber] = new (poreArena) pore(nodeIn, nodeOut);
         pore* p = tableOfAllPores[poreNumber];
         p->setId(poreNumber + 1);
         p->setRadius(250e-6);
@@ -2849,29 +2726,6 @@ void network::buildArtificialNetwork7()  // small: 2 layers of different
     }
   }
 
-  cout << "Setting neighboors..." << endl;
-
-  // setting neighboors
-
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
-
   cout << "Create Distortion..." << endl;
 
   length = 50e-6;
@@ -0,0 +1,44 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef COUNTERRANDOM_H
+#define COUNTERRANDOM_H
+
+#include <cstdint>
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC11). The number
+// drawn is a function of the seed, a stream and a counter only, so elements
+// keeping their own stream get the same numbers whatever the order or the
+// thread they are processed in.
+class counterRandom {
+ public:
+  explicit counterRandom(uint32_t seed) : seed(seed) {}
+
+  // uniform in [0, 1), with 53 random bits
+  double uniform(uint32_t stream, uint32_t counter) const {
+    uint32_t c[4] = {stream, counter, 0, 0};
+    uint32_t k[2] = {seed, 0x5eed5eed};
+    for (int round = 0; round < 10; ++round) {
+      uint64_t product0 = uint64_t(0xD2511F53) * c[0];
+      uint64_t product1 = uint64_t(0xCD9E8D57) * c[2];
+      uint32_t next[4] = {uint32_t(product1 >> 32) ^ c[1] ^ k[0],
+                          uint32_t(product1),
+                          uint32_t(product0 >> 32) ^ c[3] ^ k[1],
+                          uint32_t(product0)};
+      for (int i = 0; i < 4; ++i) c[i] = next[i];
+      k[0] += 0x9E3779B9;
+      k[1] += 0xBB67AE85;
+    }
+    uint64_t bits = (uint64_t(c[0]) << 32 | c[1]) >> 11;
+    return bits * (1. / 9007199254740992.);
+  }
+
+ private:
+  uint32_t seed;
+};
+
+#endif  // COUNTERRANDOM_H
@@ -0,0 +1,206 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "diffusionstencil.h"
+#include "network.h"
+#include "tissuecoupling.h"
+
+#include <cstring>
+
+using namespace std;
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STENCIL_SIMD
+#define STENCIL_INLINE inline __attribute__((always_inline))
+#else
+#define STENCIL_INLINE inline
+#endif
+
+namespace {
+struct stencilData {
+  const double *values;
+  const double *diagonal;
+  const double *weight;
+  const double *source;
+  double *result;
+  int nx, ny, nz;
+  int strideX, strideY;
+  int first;
+  double coefX, coefY, coefZ;
+};
+
+struct scalarLanes {
+  typedef double type;
+};
+
+#ifdef STENCIL_SIMD
+struct avx2Lanes {
+  typedef double type __attribute__((vector_size(32)));
+};
+
+struct avx512Lanes {
+  typedef double type __attribute__((vector_size(64)));
+};
+#endif
+
+// lanes::type holds one double or a vector of doubles; the same expression
+// serves the vector body and the scalar tail of each row
+template <typename lanes>
+STENCIL_INLINE void updateRows(const stencilData &d) {
+  typedef typename lanes::type type;
+  const int width = sizeof(type) / sizeof(double);
+  for (int i = 0; i < d.nx; ++i)
+    for (int j = 0; j < d.ny; ++j) {
+      int c = d.first + i * d.strideX + j * d.strideY;
+      int k = 0;
+      for (; k + width <= d.nz; k += width, c += width) {
+        type v, vW, vE, vS, vN, vD, vU, a, w, s;
+        memcpy(&v, d.values + c, sizeof(type));
+        memcpy(&vW, d.values + c - d.strideX, sizeof(type));
+        memcpy(&vE, d.values + c + d.strideX, sizeof(type));
+        memcpy(&vS, d.values + c - d.strideY, sizeof(type));
+        memcpy(&vN, d.values + c + d.strideY, sizeof(type));
+        memcpy(&vD, d.values + c - 1, sizeof(type));
+        memcpy(&vU, d.values + c + 1, sizeof(type));
+        memcpy(&a, d.diagonal + c, sizeof(type));
+        memcpy(&w, d.weight + c, sizeof(type));
+        memcpy(&s, d.source + c, sizeof(type));
+        type r = a * v +
+                 w * (d.coefX * (vW + vE) + d.coefY * (vS + vN) +
+                      d.coefZ * (vD + vU)) +
+                 s;
+        memcpy(d.result + c, &r, sizeof(type));
+      }
+      for (; k < d.nz; ++k, ++c) {
+        const double *v = d.values + c;
+        d.result[c] = d.diagonal[c] * v[0] +
+                      d.weight[c] * (d.coefX * (v[-d.strideX] + v[d.strideX]) +
+                                     d.coefY * (v[-d.strideY] + v[d.strideY]) +
+                                     d.coefZ * (v[-1] + v[1])) +
+                      d.source[c];
+      }
+    }
+}
+
+#ifdef STENCIL_SIMD
+__attribute__((target("avx2"))) void updateRowsAVX2(const stencilData &d) {
+  updateRows<avx2Lanes>(d);
+}
+
+__attribute__((target("avx512f"))) void updateRowsAVX512(
+    const stencilData &d) {
+  updateRows<avx512Lanes>(d);
+}
+#endif
+}  // namespace
+
+void diffusionStencil::resize(int nx, int ny, int nz) {
+  values.resize(nx, ny, nz);
+  result.resize(nx, ny, nz);
+  diagonal.resize(nx, ny, nz);
+  weight.resize(nx, ny, nz);
+  source.resize(nx, ny, nz);
+}
+
+void diffusionStencil::clear() {
+  cells.clear();
+  values.clear();
+  result.clear();
+  diagonal.clear();
+  weight.clear();
+  source.clear();
+}
+
+void diffusionStencil::setCoefficients(double coefX, double coefY,
+                                       double coefZ) {
+  this->coefX = coefX;
+  this->coefY = coefY;
+  this->coefZ = coefZ;
+}
+
+void diffusionStencil::fillBoundaries(bool closedBoundaries) {
+  int nx = values.getNx(), ny = values.getNy(), nz = values.getNz();
+  for (int j = 0; j < ny; ++j)
+    for (int k = 0; k < nz; ++k) {
+      values(-1, j, k) = closedBoundaries ? values(0, j, k) : 0;
+      values(nx, j, k) = closedBoundaries ? values(nx - 1, j, k) : 0;
+    }
+  for (int i = 0; i < nx; ++i)
+    for (int k = 0; k < nz; ++k) {
+      values(i, -1, k) = closedBoundaries ? values(i, 0, k) : 0;
+      values(i, ny, k) = closedBoundaries ? values(i, ny - 1, k) : 0;
+    }
+  for (int i = 0; i < nx; ++i)
+    for (int j = 0; j < ny; ++j) {
+      values(i, j, -1) = closedBoundaries ? values(i, j, 0) : 0;
+      values(i, j, nz) = closedBoundaries ? values(i, j, nz - 1) : 0;
+    }
+}
+
+void diffusionStencil::apply() {
+  if (values.getNx() == 0) return;
+
+  stencilData d;
+  d.values = &values[0];
+  d.diagonal = &diagonal[0];
+  d.weight = &weight[0];
+  d.source = &source[0];
+  d.result = &result[0];
+  d.nx = values.getNx();
+  d.ny = values.getNy();
+  d.nz = values.getNz();
+  d.strideX = values.getStrideX();
+  d.strideY = values.getStrideY();
+  d.first = values.index(0, 0, 0);
+  d.coefX = coefX;
+  d.coefY = coefY;
+  d.coefZ = coefZ;
+
+#ifdef STENCIL_SIMD
+  if (__builtin_cpu_supports("avx512f")) {
+    updateRowsAVX512(d);
+    return;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    updateRowsAVX2(d);
+    return;
+  }
+#endif
+  updateRows<scalarLanes>(d);
+}
+
+void network::prepareTissueStencil() {
+  diffusionStencil &stencil = *tissueStencil;
+  stencil.resize(tableOfBlocks.getNx(), tableOfBlocks.getNy(),
+                 tableOfBlocks.getNz());
+  stencil.cells.resize(totalBlocks);
+  for (int i = 0; i < totalBlocks; ++i) {
+    block *n = getBlock(i);
+    stencil.cells[i] = tableOfBlocks.index(n->getX(), n->getY(), n->getZ());
+  }
+}
+
+// explicit step of the tissue diffusion with the vessel exchange and the decay
+void network::setTissueStencilStep(double step) {
+  double coefX = 1 / pow(xEdgeLength / meshSizeX, 2);
+  double coefY = 1 / pow(yEdgeLength / meshSizeY, 2);
+  double coefZ = 1 / pow(zEdgeLength / meshSizeZ, 2);
+  double coeff = coefX + coefY + coefZ;
+  const tissueCoupling &exchange = *tissueExchange;
+
+  diffusionStencil &stencil = *tissueStencil;
+  stencil.setCoefficients(coefX, coefY, coefZ);
+  for (int i = 0; i < totalBlocks; ++i) {
+    block *n = getBlock(i);
+    if (n->getClosed()) continue;
+    int c = stencil.cells[i];
+    double sumSource = exchange.blockExchange[i] / n->getVolume();
+    stencil.diagonal[c] =
+        1 - step * (2 * n->getDiffusivity() * coeff + sumSource + sigma);
+    stencil.weight[c] = step * n->getDiffusivity();
+  }
+}
@@ -0,0 +1,44 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef DIFFUSIONSTENCIL_H
+#define DIFFUSIONSTENCIL_H
+
+#include "latticegrid.h"
+
+#include <vector>
+
+// Explicit 7-point diffusion update of the block lattice, on flat padded grids
+// indexed like tableOfBlocks:
+//   result = diagonal * v + weight * (coefX * (vW + vE) + coefY * (vS + vN) +
+//            coefZ * (vD + vU)) + source
+// The caller writes 0 in values for the cells that do not exchange (closed
+// blocks), and fillBoundaries sets the ghost layer: 0 outside the lattice, or
+// a copy of the adjacent cell for closed (no flux) boundaries. cells holds the
+// grid index of each block. Rows along k are updated with AVX-512 or AVX2 when
+// the processor supports them.
+struct diffusionStencil {
+  void resize(int nx, int ny, int nz);
+  void clear();
+  void setCoefficients(double coefX, double coefY, double coefZ);
+  void fillBoundaries(bool closedBoundaries);
+  void apply();
+
+  std::vector<int> cells;
+  latticeGrid<double> values;
+  latticeGrid<double> diagonal;
+  latticeGrid<double> weight;
+  latticeGrid<double> source;
+  latticeGrid<double> result;
+
+ private:
+  double coefX;
+  double coefY;
+  double coefZ;
+};
+
+#endif  // DIFFUSIONSTENCIL_H
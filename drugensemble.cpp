@@ -0,0 +1,346 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "network.h"
+#include "tissuecoupling.h"
+#include "tools.h"
+
+#include <sstream>
+
+using namespace std;
+
+// Drug flow with diffusion for several tissue parameter sets on one flow
+// field. Each line of Input Data/tissueEnsemble.txt after the header gives the
+// PVT, DT and sigma of a member: its membrane permeabilities and diffusivities
+// are those set up from the base PVT and DT, scaled by the member values. All
+// members advance together with the smallest stable explicit step, and the
+// concentrations of an element are stored member after member so that the
+// updates vectorize over the members.
+void network::runDrugFlowEnsemble() {
+  vector<double> memberPVT, memberDT, memberSigma;
+  ifstream input("Input Data/tissueEnsemble.txt");
+  if (input) {
+    string header;
+    getline(input, header);
+    double permeability, diffusivity, decay;
+    while (input >> permeability >> diffusivity >> decay) {
+      memberPVT.push_back(permeability);
+      memberDT.push_back(diffusivity);
+      memberSigma.push_back(decay);
+    }
+  }
+
+  int members = memberPVT.size();
+  if (members == 0) {
+    cout << "No members found in Input Data/tissueEnsemble.txt" << endl;
+    return;
+  }
+  if (PVT == 0 || DT == 0) {
+    cout << "The ensemble needs nonzero base PVT and DT" << endl;
+    return;
+  }
+  if (implicitDiffusion)
+    cout << "The ensemble runs with explicit diffusion" << endl;
+
+  initialiseSimulation();
+  setupTissueProperties();
+
+  cout << "Starting Flow in Network... " << endl;
+
+  double startTime, endTime;
+  startTime = tools::getCPUTime();
+
+  assignViscosities();
+  assignVolumes();
+  assignConductivities();
+
+  // set constant flow rate
+  solveForFlowRate(flowRate);
+
+  buildTissueCoupling();
+  setFeedingVessels();
+  const tissueCoupling& exchange = *tissueExchange;
+
+  vector<double> permeabilityFactor(members), diffusivityFactor(members);
+  double maxPermeabilityFactor(0);
+  for (int m = 0; m < members; ++m) {
+    permeabilityFactor[m] = memberPVT[m] / PVT;
+    diffusivityFactor[m] = memberDT[m] / DT;
+    maxPermeabilityFactor = max(maxPermeabilityFactor, permeabilityFactor[m]);
+  }
+
+  double coefX = 1 / pow(xEdgeLength / meshSizeX, 2);
+  double coefY = 1 / pow(yEdgeLength / meshSizeY, 2);
+  double coefZ = 1 / pow(zEdgeLength / meshSizeZ, 2);
+  double coeff = coefX + coefY + coefZ;
+
+  // set time step
+
+  timeStep = 1e50;
+  for (int i = 0; i < totalPores; ++i) {
+    pore* p = getPore(i);
+    if (!p->getClosed() && abs(p->getFlow()) > 1e-20) {
+      double sumSource =
+          maxPermeabilityFactor * exchange.poreExchange[i] / p->getVolume();
+      double step = 1. / (abs(p->getFlow()) / p->getVolume() + sumSource);
+      if (step < timeStep) timeStep = step;
+    }
+  }
+
+  for (int i = 0; i < totalBlocks; ++i) {
+    block* n = getBlock(i);
+    if (!n->getClosed())
+      for (int m = 0; m < members; ++m) {
+        double sumSource =
+            permeabilityFactor[m] * exchange.blockExchange[i] / n->getVolume();
+        double step = 1. / (2 * diffusivityFactor[m] * n->getDiffusivity() *
+                                coeff +
+                            sumSource + memberSigma[m]);
+        if (step < timeStep) timeStep = step;
+      }
+  }
+
+  cout << "Ensemble of " << members << " members, time step: " << timeStep
+       << endl;
+  double deltaT = timeStep;
+
+  // the six neighbours of each block, in the order -x, +x, -y, +y, -z, +z.
+  // Closed neighbours point to an extra block always at 0, and the lattice
+  // faces to the block itself for closed boundaries.
+  int zero = totalBlocks;
+  vector<int> blockNeighbours(6 * totalBlocks, zero);
+  const int shifts[6][3] = {{-1, 0, 0}, {1, 0, 0},  {0, -1, 0},
+                            {0, 1, 0},  {0, 0, -1}, {0, 0, 1}};
+  for (int i = 0; i < totalBlocks; ++i) {
+    block* n = getBlock(i);
+    if (n->getClosed()) continue;
+    for (int d = 0; d < 6; ++d) {
+      int x = n->getX() + shifts[d][0];
+      int y = n->getY() + shifts[d][1];
+      int z = n->getZ() + shifts[d][2];
+      if (!tableOfBlocks.contains(x, y, z)) {
+        if (closedBoundaries) blockNeighbours[6 * i + d] = i;
+      } else {
+        block* neighbour = tableOfBlocks(x, y, z);
+        if (neighbour != 0 && !neighbour->getClosed())
+          blockNeighbours[6 * i + d] = neighbour->getId() - 1;
+      }
+    }
+  }
+
+  // inflow of each pore from the pores feeding it, divided by its volume
+  vector<int> feedingOffsets(1, 0), feedingPores;
+  vector<double> feedingWeights;
+  for (int i = 0; i < totalPores; ++i) {
+    pore* p = getPore(i);
+    if (!p->getClosed() && !p->getInlet())
+      for (auto iterator : p->getFeedingVessels()) {
+        pore* pp = getPore(iterator.first - 1);
+        if (!pp->getClosed()) {
+          feedingPores.push_back(iterator.first - 1);
+          feedingWeights.push_back(p->getInflowShare() * iterator.second /
+                                   p->getVolume());
+        }
+      }
+    feedingOffsets.push_back(feedingPores.size());
+  }
+
+  vector<double> poreValues(totalPores * members),
+      poreNext(totalPores * members);
+  vector<double> blockValues((totalBlocks + 1) * members),
+      blockNext((totalBlocks + 1) * members);
+
+  // curves of every member, written at the end
+  vector<double> outputTimes, outletCurves, vesselCurves, tissueCurves,
+      voxelCurves;
+  vector<double> outletConc(members), averageConc(members),
+      averageTissueConc(members), averageVoxelConc(members);
+
+  double timeSoFar(0);
+  bool removeTracer(false);
+  double outputPV(0);
+  while (timeSoFar < simulationTime) {
+    double inletConcentration =
+        removeTracer ? 0 : getDrugInletConcentration(timeSoFar);
+
+#pragma omp parallel
+    {
+      vector<double> sum(members);
+
+#pragma omp for schedule(static)
+      for (int i = 0; i < totalBlocks; ++i) {
+        block* n = getBlock(i);
+        if (n->getClosed()) continue;
+
+        fill(sum.begin(), sum.end(), 0.);
+        for (int j = exchange.blockOffsets[i]; j < exchange.blockOffsets[i + 1];
+             ++j) {
+          double coefficient = exchange.blockCoefficients[j];
+          const double* c = &poreValues[exchange.blockPores[j] * members];
+          for (int m = 0; m < members; ++m) sum[m] += coefficient * c[m];
+        }
+
+        const int* neighbours = &blockNeighbours[6 * i];
+        const double* c = &blockValues[i * members];
+        const double* cW = &blockValues[neighbours[0] * members];
+        const double* cE = &blockValues[neighbours[1] * members];
+        const double* cS = &blockValues[neighbours[2] * members];
+        const double* cN = &blockValues[neighbours[3] * members];
+        const double* cD = &blockValues[neighbours[4] * members];
+        const double* cU = &blockValues[neighbours[5] * members];
+        double* next = &blockNext[i * members];
+        double diffusivity = n->getDiffusivity();
+        double volume = n->getVolume();
+        double exchangeRate = exchange.blockExchange[i] / volume;
+        for (int m = 0; m < members; ++m) {
+          double memberDiffusivity = diffusivityFactor[m] * diffusivity;
+          next[m] =
+              (1 - deltaT * (2 * memberDiffusivity * coeff +
+                             permeabilityFactor[m] * exchangeRate +
+                             memberSigma[m])) *
+                  c[m] +
+              deltaT * memberDiffusivity *
+                  (coefX * (cW[m] + cE[m]) + coefY * (cS[m] + cN[m]) +
+                   coefZ * (cD[m] + cU[m])) +
+              deltaT * permeabilityFactor[m] * sum[m] / volume;
+        }
+      }
+
+#pragma omp for schedule(static)
+      for (int i = 0; i < totalPores; ++i) {
+        pore* p = getPore(i);
+        if (p->getClosed()) continue;
+
+        double volume = p->getVolume();
+        double flowOut = abs(p->getFlow()) / volume;
+        if (p->getInlet())
+          fill(sum.begin(), sum.end(), inletConcentration * flowOut);
+        else {
+          fill(sum.begin(), sum.end(), 0.);
+          for (int j = feedingOffsets[i]; j < feedingOffsets[i + 1]; ++j) {
+            double weight = feedingWeights[j];
+            const double* c = &poreValues[feedingPores[j] * members];
+            for (int m = 0; m < members; ++m) sum[m] += weight * c[m];
+          }
+        }
+        for (int j = exchange.poreOffsets[i]; j < exchange.poreOffsets[i + 1];
+             ++j) {
+          double coefficient = exchange.poreCoefficients[j] / volume;
+          const double* c = &blockValues[exchange.poreBlocks[j] * members];
+          for (int m = 0; m < members; ++m)
+            sum[m] += permeabilityFactor[m] * coefficient * c[m];
+        }
+
+        const double* c = &poreValues[i * members];
+        double* next = &poreNext[i * members];
+        double exchangeRate = exchange.poreExchange[i] / volume;
+        for (int m = 0; m < members; ++m)
+          next[m] =
+              c[m] * (1 - deltaT * (flowOut +
+                                    permeabilityFactor[m] * exchangeRate)) +
+              deltaT * sum[m];
+      }
+    }
+
+    poreValues.swap(poreNext);
+    blockValues.swap(blockNext);
+
+    timeSoFar += deltaT;
+
+    outputPV += timeStep * flowRate;
+    if (outputPV > 0.04 * totalPoresVolume) {
+      outputPV = 0;
+
+      fill(outletConc.begin(), outletConc.end(), 0.);
+      fill(averageConc.begin(), averageConc.end(), 0.);
+      fill(averageTissueConc.begin(), averageTissueConc.end(), 0.);
+      double totalVolume(0), totalOutletVolume(0), totalTissueVolume(0);
+      for (int i = 0; i < totalPores; ++i) {
+        pore* p = getPore(i);
+        if (p->getClosed()) continue;
+        double volume = p->getVolume();
+        const double* c = &poreValues[i * members];
+        totalVolume += volume;
+        for (int m = 0; m < members; ++m) averageConc[m] += c[m] * volume;
+        if (p->getVesselType() == 3)  // vein pore
+        {
+          totalOutletVolume += volume;
+          for (int m = 0; m < members; ++m) outletConc[m] += c[m] * volume;
+        }
+      }
+      for (int i = 0; i < totalBlocks; ++i) {
+        block* n = getBlock(i);
+        if (n->getClosed()) continue;
+        double volume = n->getVolume();
+        const double* c = &blockValues[i * members];
+        totalTissueVolume += volume;
+        for (int m = 0; m < members; ++m)
+          averageTissueConc[m] += c[m] * volume;
+      }
+
+      for (int m = 0; m < members; ++m) {
+        averageVoxelConc[m] = (averageConc[m] + averageTissueConc[m]) /
+                              (xEdgeLength * yEdgeLength * zEdgeLength);
+        outletConc[m] /= totalOutletVolume;
+        averageConc[m] /= totalVolume;
+        averageTissueConc[m] /= totalTissueVolume;
+      }
+
+      outputTimes.push_back(timeSoFar);
+      outletCurves.insert(outletCurves.end(), outletConc.begin(),
+                          outletConc.end());
+      vesselCurves.insert(vesselCurves.end(), averageConc.begin(),
+                          averageConc.end());
+      tissueCurves.insert(tissueCurves.end(), averageTissueConc.begin(),
+                          averageTissueConc.end());
+      voxelCurves.insert(voxelCurves.end(), averageVoxelConc.begin(),
+                         averageVoxelConc.end());
+    }
+
+    if (bolusInjection && timeSoFar > bolusDuration) removeTracer = true;
+
+    // Thread Management
+    if (cancel) break;
+  }
+
+  // the fields of the first member are shown
+  for (int i = 0; i < totalPores; ++i) {
+    pore* p = getPore(i);
+    if (!p->getClosed()) p->setConcentration(poreValues[i * members]);
+  }
+  for (int i = 0; i < totalBlocks; ++i) {
+    block* n = getBlock(i);
+    if (!n->getClosed()) n->setConcentration(blockValues[i * members]);
+  }
+  emitPlotSignal();
+
+  for (int m = 0; m < members; ++m) {
+    stringstream suffix;
+    suffix << "_" << m + 1 << ".txt";
+    ofstream ofs1("Results/outletConcentration" + suffix.str());
+    ofstream ofs2("Results/averageConcentration" + suffix.str());
+    ofstream ofs3("Results/averageTissueConcentration" + suffix.str());
+    ofstream ofs4("Results/averageVoxelConcentration" + suffix.str());
+
+    ofs1 << "t OutletConc" << endl;
+    ofs2 << "t AvgVesselConc" << endl;
+    ofs3 << "t AvgTissueConc" << endl;
+    ofs4 << "t AvgVoxelConc" << endl;
+
+    for (unsigned k = 0; k < outputTimes.size(); ++k) {
+      ofs1 << outputTimes[k] << " " << outletCurves[k * members + m] << "\n";
+      ofs2 << outputTimes[k] << " " << vesselCurves[k * members + m] << "\n";
+      ofs3 << outputTimes[k] << " " << tissueCurves[k * members + m] << "\n";
+      ofs4 << outputTimes[k] << " " << voxelCurves[k * members + m] << "\n";
+    }
+  }
+
+  cout << "Simulation Time " << timeSoFar << endl;
+
+  endTime = tools::getCPUTime();
+  cout << "Processing Time: " << endTime - startTime << " s" << endl;
+}
@@ -6,6 +6,11 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "diffusionstencil.h"
+#include "networkarrays.h"
+#include "networkgraph.h"
+#include "snapshotwriter.h"
+#include "tissuecoupling.h"
 #include "tools.h"
 
 using namespace std;
@@ -42,29 +47,7 @@ void network::runDrugFlowWithoutDiffusion() {
   assignConductivities();
 
   // set constant flow rate
-  double Q1(0), Q2(0), A, B;
-
-  pressureIn = 1;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q1 = getOutletFlow();
-
-  pressureIn = 2;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q2 = getOutletFlow();
-
-  B = (Q1 - Q2 * 1 / 2) / (1 - 1 / 2);
-  A = (Q1 - B);
-
-  deltaP = flowRate / A - B / A;
-
-  pressureIn = deltaP;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
+  solveForFlowRate(flowRate);
 
   // Mass conservation check
 
@@ -108,143 +91,84 @@ void network::runDrugFlowWithoutDiffusion() {
     file3 << p->getId() << " " << p->getConductivity() << endl;
   }
 
+  // the time loop runs on contiguous copies of the opened pores and nodes
+  gatherNetworkArrays();
+  networkArrays& a = *vesselArrays;
+
+  // with several time step levels, timeStep becomes the step of the slowest
+  // level and the faster levels take several substeps within it
+  double multirateStep = timeStep;
+  int multirateSubsteps = 1;
+  if (timeStepLevels < 1 || timeStepLevels > 20) {
+    // the substeps of the slowest level are counted in an int
+    timeStepLevels = max(1, min(20, timeStepLevels));
+    cout << "Time step levels limited to " << timeStepLevels << endl;
+  }
+  if (implicitTransport) {
+    if (implicitTimeStep > 0)
+      timeStep = implicitTimeStep;
+    else
+      cout << "Implicit time step must be positive: using " << timeStep
+           << endl;
+    if (!a.sortNodesAlongFlow())
+      cout << "Flow loops found: implicit transport is approximate" << endl;
+  } else if (timeStepLevels > 1 && !impulseResponse) {
+    multirateSubsteps = 1 << a.assignTimeStepLevels(timeStep, timeStepLevels);
+    timeStep = multirateStep * multirateSubsteps;
+  }
+
   cout << timeStep << endl;
 
+  if (impulseResponse) {
+    timeSoFar = runDrugImpulseResponse(ofs1, ofs2);
+
+    cout << "Simulation Time " << timeSoFar << endl;
+
+    endTime = tools::getCPUTime();
+    cout << "Processing Time: " << endTime - startTime << " s" << endl;
+    return;
+  }
+
   // post-processing
   if (videoRecording) record = true;
 
+  int nodesNumber = a.getNodesNumber();
+
+  const networkGraph& graph = a.nodePores;
+
   int k(0);
   double oldAverageConc(0);
   double outputPV(0);
   double outputPV2(0);
 
   while (timeSoFar < simulationTime) {
-    int fullyConcentratedPores = 0;
-    int fullyConcentratedPoresBefore = 0;
-
-    for (int i = 0; i < totalNodes; ++i) {
-      node* n = getNode(i);
-      if (!n->getClosed()) {
-        vector<int>& connectedPores = n->getConnectedPores();
-        double sumFlowIn = 0;
-        double massIn = 0;
-        for (unsigned j = 0; j < connectedPores.size(); ++j) {
-          pore* p = getPore(connectedPores[j] - 1);
-          if (!p->getClosed()) {
-            if ((p->getNodeIn() == n && p->getFlow() > 0) ||
-                (p->getNodeOut() == n && p->getFlow() < 0)) {
-              sumFlowIn += abs(p->getFlow());
-              massIn += p->getConcentration() * abs(p->getFlow());
-            }
-          }
-        }
-        n->setFlow(sumFlowIn);
-        n->setMassFlow(massIn);
-      }
-    }
-
-    double massIn = 0;
-    double flowIn = 0;
-
-    for (int i = 0; i < totalPores; ++i) {
-      pore* p = getPore(i);
-      if (!p->getClosed()) {
-        if (p->getInlet())  // inlet pore
-        {
-          // AIF
-          double A1, A2, T1, T2, sigma1, sigma2, alpha, beta, s, tau, time;
-          A1 = 0.809;
-          A2 = 0.33;
-          T1 = 0.17046;
-          T2 = 0.365;
-          sigma1 = 0.0563;
-          sigma2 = 0.132;
-          alpha = 1.05;
-          beta = 0.1685;
-          s = 38.078;
-          tau = 0.483;
-          time = timeSoFar / 60.;
-
-          double concentration =
-              bolusInjection
-                  ? 1
-                  : A1 / (sigma1 * sqrt(2 * tools::pi())) *
-                            exp(-pow((time - T1), 2) / (2 * pow(sigma1, 2))) +
-                        A2 / (sigma2 * sqrt(2 * tools::pi())) *
-                            exp(-pow((time - T2), 2) / (2 * pow(sigma2, 2))) +
-                        alpha * exp(-beta * time) /
-                            (1 + exp(-s * (time - tau)));
-          if (AIFInjection) concentration /= 6.2;
-          massIn = concentration * abs(p->getFlow());
-          flowIn = abs(p->getFlow());
-
-          if (removeTracer) flowIn = 0;
-        }
-
-        else {
-          if (p->getFlow() > 0) {
-            massIn = p->getNodeOut()->getMassFlow();
-            flowIn = p->getNodeOut()->getFlow();
-          } else {
-            massIn = p->getNodeIn()->getMassFlow();
-            flowIn = p->getNodeIn()->getFlow();
-          }
-        }
-
-        if (abs(p->getFlow()) < 1e-20 || flowIn < 1e-20) {
-          massIn = 0;
-          flowIn = 1;
-        }
-
-        if (p->getConcentration() > 0.5) fullyConcentratedPoresBefore++;
-        p->setConcentration(p->getConcentration() +
-                            (abs(p->getFlow()) / flowIn * massIn -
-                             abs(p->getFlow()) * p->getConcentration()) *
-                                timeStep / p->getVolume());
-        if (p->getConcentration() > 0.5) fullyConcentratedPores++;
-      }
-    }
-
-    for (int i = 0; i < totalNodes; ++i) {
-      node* n = getNode(i);
-      if (!n->getClosed()) {
-        double concentration(0);
-        double neighboorsNumber(0);
-        vector<int>& connectedPores = n->getConnectedPores();
-        for (unsigned j = 0; j < connectedPores.size(); j++) {
-          pore* npore = getPore(connectedPores[j] - 1);
-          if (!npore->getClosed()) {
-            concentration += npore->getConcentration();
-            neighboorsNumber++;
-          }
-        }
-        n->setConcentration(concentration / neighboorsNumber);
-        // if(n->getConcentration()<-0.001 || n->getConcentration()>1.001)
-        // cout<<"nfuck"<<n->getConcentration()<<endl;
-      }
+    double inletConcentration =
+        removeTracer ? 0 : getDrugStepConcentration(timeSoFar);
+
+    if (implicitTransport)
+      advectDrugImplicitly(inletConcentration);
+    else if (multirateSubsteps > 1)
+      advectDrugMultirate(timeSoFar, multirateStep, multirateSubsteps);
+    else
+      advectDrugExplicitly(inletConcentration);
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < nodesNumber; ++i) {
+      double concentration(0);
+      for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j)
+        concentration += a.poreConcentration[graph.pores[j]];
+      a.nodeConcentration[i] =
+          concentration / (graph.offsets[i + 1] - graph.offsets[i]);
     }
 
     timeSoFar += timeStep;
     k++;
 
+    scatterConcentrations();
     emitPlotSignal();
 
-    double averageConc(0), outletConc(0), totalVolume(0), totalOutletVolume(0);
-    for (int i = 0; i < totalPores; ++i) {
-      pore* p = getPore(i);
-      if (!p->getClosed()) {
-        totalVolume += p->getVolume();
-        averageConc += p->getConcentration() * p->getVolume();
-        if (p->getVesselType() == 3)  // vein pore
-        {
-          totalOutletVolume += p->getVolume();
-          outletConc += p->getConcentration() * p->getVolume();
-        }
-      }
-    }
-
-    outletConc /= totalOutletVolume;
-    averageConc /= totalVolume;
+    double averageConc, outletConc;
+    averageDrugConcentrations(averageConc, outletConc);
 
     outputPV += timeStep * flowRate;
     outputPV2 += timeStep * flowRate;
@@ -273,6 +197,9 @@ void network::runDrugFlowWithoutDiffusion() {
     if (cancel) break;
   }
 
+  // the snapshots are read back for the video
+  snapshots->finish();
+
   // post-processing
   if (videoRecording) {
     record = false;
@@ -285,6 +212,343 @@ void network::runDrugFlowWithoutDiffusion() {
   cout << "Processing Time: " << endTime - startTime << " s" << endl;
 }
 
+double network::getDrugInletConcentration(double time) {
+  if (bolusInjection) return 1;
+
+  // AIF
+  double A1, A2, T1, T2, sigma1, sigma2, alpha, beta, s, tau;
+  A1 = 0.809;
+  A2 = 0.33;
+  T1 = 0.17046;
+  T2 = 0.365;
+  sigma1 = 0.0563;
+  sigma2 = 0.132;
+  alpha = 1.05;
+  beta = 0.1685;
+  s = 38.078;
+  tau = 0.483;
+  time /= 60.;
+
+  double concentration =
+      A1 / (sigma1 * sqrt(2 * tools::pi())) *
+          exp(-pow((time - T1), 2) / (2 * pow(sigma1, 2))) +
+      A2 / (sigma2 * sqrt(2 * tools::pi())) *
+          exp(-pow((time - T2), 2) / (2 * pow(sigma2, 2))) +
+      alpha * exp(-beta * time) / (1 + exp(-s * (time - tau)));
+  if (AIFInjection) concentration /= 6.2;
+  return concentration;
+}
+
+// inlet concentration held over the step starting at time
+double network::getDrugStepConcentration(double time) {
+  // the implicit scheme takes the inlet at the end of the step
+  double concentration =
+      getDrugInletConcentration(implicitTransport ? time + timeStep : time);
+
+  // long implicit steps may end after the bolus: inject over the part of the
+  // step it covers to keep the injected mass
+  if (implicitTransport && bolusInjection)
+    concentration *= min(1., max(0., (bolusDuration - time) / timeStep));
+  return concentration;
+}
+
+// Explicit upwind step: each pore takes in the mixture of the pores feeding its
+// upstream node, and the inlet pores the inlet concentration.
+void network::advectDrugExplicitly(double inletConcentration) {
+  networkArrays& a = *vesselArrays;
+  const networkGraph& graph = a.nodePores;
+  int poresNumber = a.getPoresNumber();
+  int nodesNumber = a.getNodesNumber();
+
+  // inflow and incoming mass of each node
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < nodesNumber; ++i) {
+    double sumFlowIn(0), massIn(0);
+    for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j) {
+      int q = graph.pores[j];
+      double flowIn = max(graph.signs[j] * a.poreFlow[q], 0.);
+      sumFlowIn += flowIn;
+      massIn += a.poreConcentration[q] * flowIn;
+    }
+    a.nodeFlow[i] = sumFlowIn;
+    a.nodeMassFlow[i] = massIn;
+  }
+
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < poresNumber; ++i) {
+    double flow = abs(a.poreFlow[i]);
+    double massIn(0), flowIn(0);
+    if (a.poreInlet[i]) {
+      massIn = inletConcentration * flow;
+      flowIn = flow;
+    } else {
+      int upstream = a.getUpstreamNode(i);
+      if (upstream != -1) {
+        massIn = a.nodeMassFlow[upstream];
+        flowIn = a.nodeFlow[upstream];
+      }
+    }
+
+    if (flow < 1e-20 || flowIn < 1e-20) {
+      massIn = 0;
+      flowIn = 1;
+    }
+
+    a.poreConcentration[i] +=
+        (flow / flowIn * massIn - flow * a.poreConcentration[i]) * timeStep /
+        a.poreVolume[i];
+  }
+}
+
+// Volume averages of the concentration over the network and over the vein
+// pores. They are summed over a fixed number of pore blocks and the block sums
+// are added in order, so the results do not depend on the thread scheduling.
+void network::averageDrugConcentrations(double& averageConc,
+                                        double& outletConc) {
+  networkArrays& a = *vesselArrays;
+  int poresNumber = a.getPoresNumber();
+  int sumBlocks = tools::maxThreads();
+  vector<double> blockSums(4 * sumBlocks);
+
+#pragma omp parallel for schedule(static)
+  for (int b = 0; b < sumBlocks; ++b) {
+    double sumVolume(0), sumConc(0), sumOutletVolume(0), sumOutletConc(0);
+    int first = (long long)poresNumber * b / sumBlocks;
+    int last = (long long)poresNumber * (b + 1) / sumBlocks;
+    for (int i = first; i < last; ++i) {
+      sumVolume += a.poreVolume[i];
+      sumConc += a.poreConcentration[i] * a.poreVolume[i];
+      if (a.poreVesselType[i] == 3)  // vein pore
+      {
+        sumOutletVolume += a.poreVolume[i];
+        sumOutletConc += a.poreConcentration[i] * a.poreVolume[i];
+      }
+    }
+    blockSums[4 * b] = sumVolume;
+    blockSums[4 * b + 1] = sumConc;
+    blockSums[4 * b + 2] = sumOutletVolume;
+    blockSums[4 * b + 3] = sumOutletConc;
+  }
+
+  double totalVolume(0), totalOutletVolume(0);
+  averageConc = 0;
+  outletConc = 0;
+  for (int b = 0; b < sumBlocks; ++b) {
+    totalVolume += blockSums[4 * b];
+    averageConc += blockSums[4 * b + 1];
+    totalOutletVolume += blockSums[4 * b + 2];
+    outletConc += blockSums[4 * b + 3];
+  }
+
+  outletConc /= totalOutletVolume;
+  averageConc /= totalVolume;
+}
+
+// The transport without diffusion is linear and does not change in time: the
+// averages after step n are the sum over m of h[n - m] * u[m], with u[m] the
+// inlet concentration of step m and h the averages after a unit inlet in the
+// first step only. h is kept for the flow field it was computed on, so runs
+// with another inlet function only redo the convolution. Returns the time
+// reached.
+double network::runDrugImpulseResponse(ofstream& outletFile,
+                                       ofstream& averageFile) {
+  networkArrays& a = *vesselArrays;
+
+  // inlet concentrations and end times of the steps of a direct run
+  vector<double> inlet, times;
+  bool removeTracer(false);
+  double time(0);
+  while (time < simulationTime) {
+    inlet.push_back(removeTracer ? 0 : getDrugStepConcentration(time));
+    time += timeStep;
+    times.push_back(time);
+    if (bolusInjection && time > bolusDuration) removeTracer = true;
+  }
+  unsigned steps = times.size();
+
+  // the response depends on the step, the scheme and the whole flow field;
+  // flows solved again for the same network only differ by round-off
+  vector<double> key = {timeStep, double(implicitTransport)};
+  key.insert(key.end(), a.poreVolume.begin(), a.poreVolume.end());
+  bool sameFlows = impulseFlows.size() == a.poreFlow.size();
+  for (unsigned i = 0; sameFlows && i < impulseFlows.size(); ++i)
+    sameFlows = abs(a.poreFlow[i] - impulseFlows[i]) <= 1e-9 * flowRate;
+  if (key != impulseKey || !sameFlows || impulseOutlet.size() < steps) {
+    impulseKey.clear();
+    impulseFlows.clear();
+    impulseOutlet.assign(steps, 0);
+    impulseAverage.assign(steps, 0);
+
+    fill(a.poreConcentration.begin(), a.poreConcentration.end(), 0.);
+    for (unsigned k = 0; k < steps; ++k) {
+      double inletConcentration = k == 0 ? 1 : 0;
+      if (implicitTransport)
+        advectDrugImplicitly(inletConcentration);
+      else
+        advectDrugExplicitly(inletConcentration);
+      averageDrugConcentrations(impulseAverage[k], impulseOutlet[k]);
+
+      // Thread Management
+      if (cancel) return times[k];
+    }
+    impulseKey = key;
+    impulseFlows = a.poreFlow;
+
+    // the fields of the impulse run are not those of the simulated injection
+    fill(a.poreConcentration.begin(), a.poreConcentration.end(), 0.);
+    fill(a.nodeConcentration.begin(), a.nodeConcentration.end(), 0.);
+    scatterConcentrations();
+    emitPlotSignal();
+
+    ofstream file("Results/impulseResponse.txt");
+    file << "t OutletResponse AvgResponse" << endl;
+    for (unsigned k = 0; k < steps; ++k)
+      file << times[k] << " " << impulseOutlet[k] << " " << impulseAverage[k]
+           << endl;
+  } else
+    cout << "Reusing the impulse response" << endl;
+
+  vector<double> outletConc = tools::convolve(
+      vector<double>(impulseOutlet.begin(), impulseOutlet.begin() + steps),
+      inlet);
+  vector<double> averageConc = tools::convolve(
+      vector<double>(impulseAverage.begin(), impulseAverage.begin() + steps),
+      inlet);
+
+  double outputPV(0);
+  for (unsigned k = 0; k < steps; ++k) {
+    outputPV += timeStep * flowRate;
+    if (outputPV > 0.04 * totalPoresVolume) {
+      outputPV = 0;
+      outletFile << times[k] << " " << outletConc[k] << endl;
+      averageFile << times[k] << " " << averageConc[k] << endl;
+    }
+  }
+
+  return times.back();
+}
+
+// Backward Euler upwind step: each pore is solved from the mixed concentration
+// at its upstream node at the end of the step, which only depends on pores
+// further upstream. Sweeping the nodes along the flow solves the whole system
+// in one pass, stable for any time step and conservative at the nodes.
+void network::advectDrugImplicitly(double inletConcentration) {
+  networkArrays& a = *vesselArrays;
+  const networkGraph& graph = a.nodePores;
+
+  auto update = [&](int i, double concentrationIn) {
+    double ratio = abs(a.poreFlow[i]) * timeStep / a.poreVolume[i];
+    a.poreConcentration[i] =
+        (a.poreConcentration[i] + ratio * concentrationIn) / (1 + ratio);
+  };
+
+  for (int i = 0; i < a.getPoresNumber(); ++i) {
+    if (a.poreInlet[i])
+      update(i, inletConcentration);
+    else if (a.getUpstreamNode(i) == -1)
+      update(i, 0);
+  }
+
+  for (unsigned l = 0; l < a.nodeOrder.size(); ++l) {
+    int n = a.nodeOrder[l];
+    double sumFlowIn(0), massIn(0);
+    for (int j = graph.offsets[n]; j < graph.offsets[n + 1]; ++j) {
+      int q = graph.pores[j];
+      double flowIn = max(graph.signs[j] * a.poreFlow[q], 0.);
+      sumFlowIn += flowIn;
+      massIn += a.poreConcentration[q] * flowIn;
+    }
+    a.nodeFlow[n] = sumFlowIn;
+    a.nodeMassFlow[n] = massIn;
+
+    double concentrationIn = sumFlowIn < 1e-20 ? 0 : massIn / sumFlowIn;
+    for (int j = graph.offsets[n]; j < graph.offsets[n + 1]; ++j) {
+      int q = graph.pores[j];
+      if (!a.poreInlet[q] && a.getUpstreamNode(q) == n)
+        update(q, concentrationIn);
+    }
+  }
+}
+
+// Explicit upwind step from time made of `substeps` substeps: the pores of
+// level l are updated every 2^l substeps. Each node integrates in time the
+// mixed concentration of its feeding pores, held between their updates, and a
+// pore takes in its flow times the integral over its own step, so the mass
+// leaving the faster and slower pores meeting at a node is exactly passed on.
+void network::advectDrugMultirate(double time, double step,
+                                  int substeps) {
+  networkArrays& a = *vesselArrays;
+  const networkGraph& graph = a.nodePores;
+  int nodesNumber = a.getNodesNumber();
+  int inlet = nodesNumber;
+
+  auto mix = [&](int n) {
+    double sumFlowIn(0), massIn(0);
+    for (int j = graph.offsets[n]; j < graph.offsets[n + 1]; ++j) {
+      int q = graph.pores[j];
+      double flowIn = max(graph.signs[j] * a.poreFlow[q], 0.);
+      sumFlowIn += flowIn;
+      massIn += a.poreConcentration[q] * flowIn;
+    }
+    a.nodeMixedConcentration[n] = sumFlowIn < 1e-20 ? 0 : massIn / sumFlowIn;
+  };
+  auto integral = [&](int n, int substep) {
+    return a.nodeInflowIntegral[n] + a.nodeMixedConcentration[n] * step *
+                                         (substep - a.nodeIntegralSubstep[n]);
+  };
+  auto advance = [&](int n, int substep) {
+    a.nodeInflowIntegral[n] = integral(n, substep);
+    a.nodeIntegralSubstep[n] = substep;
+  };
+
+  // all pores are in step at the start
+  fill(a.nodeInflowIntegral.begin(), a.nodeInflowIntegral.end(), 0.);
+  fill(a.nodeIntegralSubstep.begin(), a.nodeIntegralSubstep.end(), 0);
+  fill(a.poreInflowStart.begin(), a.poreInflowStart.end(), 0.);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < nodesNumber; ++i) mix(i);
+
+  for (int substep = 1; substep <= substeps; ++substep) {
+    double substepTime = time + (substep - 1) * step;
+    advance(inlet, substep - 1);
+    a.nodeMixedConcentration[inlet] =
+        bolusInjection && substepTime > bolusDuration
+            ? 0
+            : getDrugInletConcentration(substepTime);
+
+    // levels 0 to level end their step now, and are stored first
+    int level = 0;
+    while (level < a.getLevelsNumber() - 1 && substep % (2 << level) == 0)
+      ++level;
+    int updated = a.levelOffsets[level + 1];
+
+#pragma omp parallel for schedule(static)
+    for (int l = 0; l < updated; ++l) {
+      int i = a.levelPores[l];
+      int n = a.poreInflowNode[i];
+      double flow = abs(a.poreFlow[i]);
+      double inflow = integral(n, substep);
+      a.poreNextConcentration[i] =
+          a.poreConcentration[i] +
+          flow *
+              (inflow - a.poreInflowStart[i] -
+               a.poreConcentration[i] * ldexp(step, a.poreLevel[i])) /
+              a.poreVolume[i];
+      a.poreInflowStart[i] = inflow;
+    }
+
+    for (int l = 0; l < updated; ++l) {
+      int i = a.levelPores[l];
+      a.poreConcentration[i] = a.poreNextConcentration[i];
+      int downstream = a.getDownstreamNode(i);
+      if (downstream != -1) {
+        advance(downstream, substep);
+        mix(downstream);
+      }
+    }
+  }
+}
+
 void network::runDrugFlowWithDiffusion() {
   initialiseSimulation();
   setupTissueProperties();
@@ -325,29 +589,7 @@ void network::runDrugFlowWithDiffusion() {
   assignConductivities();
 
   // set constant flow rate
-  double Q1(0), Q2(0), A, B;
-
-  pressureIn = 1;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q1 = getOutletFlow();
-
-  pressureIn = 2;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q2 = getOutletFlow();
-
-  B = (Q1 - Q2 * 1 / 2) / (1 - 1 / 2);
-  A = (Q1 - B);
-
-  deltaP = flowRate / A - B / A;
-
-  pressureIn = deltaP;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
+  solveForFlowRate(flowRate);
 
   // Mass conservation check
 
@@ -380,28 +622,18 @@ void network::runDrugFlowWithDiffusion() {
   double hy = yEdgeLength / meshSizeY;
   double hz = zEdgeLength / meshSizeZ;
 
-  double coefX = 1 / pow(hx, 2);
-  double coefY = 1 / pow(hy, 2);
-  double coefZ = 1 / pow(hz, 2);
   double coeff = 1 / pow(hx, 2) + 1 / pow(hy, 2) + 1 / pow(hz, 2);
 
+  buildTissueCoupling();
+  const tissueCoupling& exchange = *tissueExchange;
+
   // set time step
 
   timeStep = 1e50;
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
     if (!p->getClosed() && abs(p->getFlow()) > 1e-20) {
-      double sumSource = 0;
-      auto& neigh = p->neighbooringBlocksArea();
-      for (auto iterator : neigh) {
-        int blockID = iterator.first;
-        block* bb = getBlock(blockID - 1);
-        if (!bb->getClosed()) {
-          double area = iterator.second;
-          sumSource += p->getMembranePermeability() * area / (p->getVolume());
-        }
-      }
-
+      double sumSource = exchange.poreExchange[i] / p->getVolume();
       double step = 1. / (abs(p->getFlow()) / p->getVolume() + sumSource);
       if (step < timeStep) timeStep = step;
     }
@@ -420,58 +652,34 @@ void network::runDrugFlowWithDiffusion() {
   }
 
   cout << "Time step without diffusion: " << timeStep << endl;
+  double vesselTimeStep = timeStep;
 
   for (int i = 0; i < totalBlocks; ++i) {
     block* n = getBlock(i);
     if (!n->getClosed()) {
-      double sumSource = 0;
-
-      map<int, double>& neigh = n->neighbooringVesselsArea();
-      for (auto iterator : neigh) {
-        int poreID = iterator.first;
-        pore* pp = getPore(poreID - 1);
-        if (!pp->getClosed()) {
-          double area = iterator.second;
-          sumSource += pp->getMembranePermeability() * area / (n->getVolume());
-        }
-      }
-
+      double sumSource = exchange.blockExchange[i] / n->getVolume();
       double step = 1. / (2 * n->getDiffusivity() * coeff + sumSource + sigma);
       if (step < timeStep) timeStep = step;
     }
   }
 
   cout << "Time step with diffusion: " << timeStep << endl;
-  double deltaT = timeStep;
 
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed()) {
-      if (!p->getInlet())  // inlet pore
-      {
-        p->getFeedingVessels().clear();
-        double totalInflow(0);
-        vector<pore*> connectedPores = p->getNeighboors();
-        for (unsigned j = 0; j < connectedPores.size(); j++) {
-          pore* npore = connectedPores[j];
-          if (!npore->getClosed()) {
-            if ((p->getFlow() > 0 && npore->getFlow() > 0 &&
-                 npore->getNodeIn() == p->getNodeOut()) ||
-                (p->getFlow() > 0 && npore->getFlow() < 0 &&
-                 npore->getNodeOut() == p->getNodeOut()) ||
-                (p->getFlow() < 0 && npore->getFlow() > 0 &&
-                 npore->getNodeIn() == p->getNodeIn()) ||
-                (p->getFlow() < 0 && npore->getFlow() < 0 &&
-                 npore->getNodeOut() == p->getNodeIn())) {
-              p->getFeedingVessels()[npore->getId()] = abs(npore->getFlow());
-              totalInflow += abs(npore->getFlow());
-            }
-          }
-        }
-        p->setInflowShare(abs(p->getFlow()) / totalInflow);
-      }
-    }
+  // the implicit tissue update is stable at any step, the coupled loop then
+  // runs at the vessel time step
+  if (implicitDiffusion) {
+    timeStep = vesselTimeStep;
+    assembleTissueDiffusion(timeStep);
+    cout << "Time step with implicit diffusion: " << timeStep << endl;
   }
+  double deltaT = timeStep;
+  if (!implicitDiffusion) {
+    prepareTissueStencil();
+    setTissueStencilStep(deltaT);
+  }
+
+  setFeedingVessels();
+  const networkGraph& graph = *nodePores;
 
   // post-processing
   if (videoRecording) record = true;
@@ -479,121 +687,45 @@ void network::runDrugFlowWithDiffusion() {
   int k(0);
   double outputPV(0);
   double outputPV2(0);
+  vector<double> blockValues(totalBlocks), poreValues(totalPores);
+  vector<double> blockSources, poreSources;
   while (timeSoFar < simulationTime) {
     vector<double> blockConcentration;
     vector<double> poreConcentration;
     blockConcentration.reserve(totalBlocks);
     poreConcentration.reserve(totalPores);
 
-    for (int i = 0; i < totalBlocks; ++i) {
-      block* n = getBlock(i);
-      if (!n->getClosed()) {
-        double ii = n->getX();
-        double jj = n->getY();
-        double kk = n->getZ();
-
-        block *nW, *nE, *nN, *nS, *nU, *nD;
-        nW = getBlock(ii - 1, jj, kk);
-        nE = getBlock(ii + 1, jj, kk);
-        nS = getBlock(ii, jj - 1, kk);
-        nN = getBlock(ii, jj + 1, kk);
-        nD = getBlock(ii, jj, kk - 1);
-        nU = getBlock(ii, jj, kk + 1);
-
-        double sumSource = 0;
-        double sumSource2 = 0;
-
-        map<int, double>& neigh = n->neighbooringVesselsArea();
-        for (auto iterator : neigh) {
-          int poreID = iterator.first;
-          pore* pp = getPore(poreID - 1);
-          if (!pp->getClosed()) {
-            double area = iterator.second;
-            sumSource +=
-                pp->getMembranePermeability() * area / (n->getVolume());
-            sumSource2 += pp->getConcentration() *
-                          pp->getMembranePermeability() * area /
-                          (n->getVolume());
-          }
-        }
-
-        double newConcentration(0);
-
-        newConcentration += n->getConcentration() *
-                            (1 - deltaT * (2 * n->getDiffusivity() * coeff +
-                                           sumSource + sigma));
-        if (nW != 0)
-          if (!nW->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * nW->getConcentration();
-        if (nE != 0)
-          if (!nE->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * nE->getConcentration();
-        if (nS != 0)
-          if (!nS->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * nS->getConcentration();
-        if (nN != 0)
-          if (!nN->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * nN->getConcentration();
-        if (nD != 0)
-          if (!nD->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * nD->getConcentration();
-        if (nU != 0)
-          if (!nU->getClosed())
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * nU->getConcentration();
-
-        if (closedBoundaries) {
-          if (nW == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * n->getConcentration();
-          if (nE == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefX * n->getConcentration();
-          if (nS == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * n->getConcentration();
-          if (nN == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefY * n->getConcentration();
-          if (nD == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * n->getConcentration();
-          if (nU == 0)
-            newConcentration +=
-                deltaT * n->getDiffusivity() * coefZ * n->getConcentration();
-        }
-
-        newConcentration += deltaT * sumSource2;
-
-        blockConcentration.push_back(newConcentration);
+    for (int i = 0; i < totalBlocks; ++i)
+      blockValues[i] = getBlock(i)->getConcentration();
+    for (int i = 0; i < totalPores; ++i)
+      poreValues[i] = getPore(i)->getConcentration();
+    exchange.blockSources(poreValues, blockSources);
+    exchange.poreSources(blockValues, poreSources);
+
+    if (implicitDiffusion)
+      solveTissueDiffusion(deltaT, blockSources, blockConcentration);
+    else {
+      diffusionStencil& stencil = *tissueStencil;
+      for (int i = 0; i < totalBlocks; ++i) {
+        block* n = getBlock(i);
+        int c = stencil.cells[i];
+        stencil.values[c] = n->getClosed() ? 0 : n->getConcentration();
+        stencil.source[c] = deltaT * blockSources[i] / n->getVolume();
       }
+      stencil.fillBoundaries(closedBoundaries);
+      stencil.apply();
+      for (int i = 0; i < totalBlocks; ++i)
+        if (!getBlock(i)->getClosed())
+          blockConcentration.push_back(stencil.result[stencil.cells[i]]);
     }
 
     for (int i = 0; i < totalPores; ++i) {
       pore* p = getPore(i);
       if (!p->getClosed()) {
-        double sumSource = 0;
-        double sumSource2 = 0;
+        double sumSource = exchange.poreExchange[i] / p->getVolume();
+        double sumSource2 = poreSources[i] / p->getVolume();
         double sumInflow = 0;
 
-        auto& neigh = p->neighbooringBlocksArea();
-        for (auto iterator : neigh) {
-          int blockID = iterator.first;
-          block* bb = getBlock(blockID - 1);
-          if (!bb->getClosed()) {
-            double area = iterator.second;
-            sumSource += p->getMembranePermeability() * area / (p->getVolume());
-            sumSource2 += bb->getConcentration() *
-                          p->getMembranePermeability() * area /
-                          (p->getVolume());
-          }
-        }
-
         if (p->getInlet()) {
           if (removeTracer)
             sumInflow = 0;
@@ -681,9 +813,8 @@ void network::runDrugFlowWithDiffusion() {
       if (!n->getClosed()) {
         double concentration(0);
         double neighboorsNumber(0);
-        vector<int> connectedPores = n->getConnectedPores();
-        for (unsigned j = 0; j < connectedPores.size(); j++) {
-          pore* npore = getPore(connectedPores[j] - 1);
+        for (int l = graph.offsets[i]; l < graph.offsets[i + 1]; ++l) {
+          pore* npore = getPore(graph.pores[l]);
           if (!npore->getClosed()) {
             concentration += npore->getConcentration();
             neighboorsNumber++;
@@ -761,6 +892,9 @@ void network::runDrugFlowWithDiffusion() {
     if (cancel) break;
   }
 
+  // the snapshots are read back for the video
+  snapshots->finish();
+
   // post-processing
   if (videoRecording) {
     record = false;
@@ -772,3 +906,32 @@ void network::runDrugFlowWithDiffusion() {
   endTime = tools::getCPUTime();
   cout << "Processing Time: " << endTime - startTime << " s" << endl;
 }
+
+void network::setFeedingVessels() {
+  // the pores flowing into the upstream node of each pore, and the share of
+  // that inflow entering the pore
+  updateNetworkGraph();
+  const networkGraph& graph = *nodePores;
+  for (int i = 0; i < totalPores; ++i) {
+    pore* p = getPore(i);
+    if (p->getClosed() || p->getInlet()) continue;
+
+    p->getFeedingVessels().clear();
+    double totalInflow(0);
+    node* n = 0;
+    if (p->getFlow() > 0) n = p->getNodeOut();
+    if (p->getFlow() < 0) n = p->getNodeIn();
+    if (n != 0) {
+      int row = n->getId() - 1;
+      for (int j = graph.offsets[row]; j < graph.offsets[row + 1]; ++j) {
+        pore* npore = getPore(graph.pores[j]);
+        if (npore != p && !npore->getClosed() &&
+            graph.signs[j] * npore->getFlow() > 0) {
+          p->getFeedingVessels()[npore->getId()] = abs(npore->getFlow());
+          totalInflow += abs(npore->getFlow());
+        }
+      }
+    }
+    p->setInflowShare(abs(p->getFlow()) / totalInflow);
+  }
+}
@@ -0,0 +1,114 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef ELEMENTARENA_H
+#define ELEMENTARENA_H
+
+#include <new>
+#include <vector>
+
+// Storage for the elements of one type owned by the network. Elements are
+// placed one after the other in large chunks with `new (arena) T(...)` and are
+// never freed individually: clear() runs the destructor of each element and
+// keeps the chunks for the next model, release() also returns the memory.
+// Pores, nodes and blocks own vectors and maps, so clear() still costs one
+// destructor call and the frees of those containers per element.
+template <typename T>
+class elementArena {
+ public:
+  elementArena() : current(0), count(0) {}
+  ~elementArena() { release(); }
+
+  elementArena(const elementArena &) = delete;
+  elementArena &operator=(const elementArena &) = delete;
+
+  // guarantees that the next n elements are stored contiguously; empty chunks
+  // too small for them are freed, so that loading a larger model after
+  // clear() does not keep the chunks of the smaller one
+  void reserve(int n) {
+    while (current < chunks.size() &&
+           chunks[current].capacity - chunks[current].used < n) {
+      if (chunks[current].used == 0) {
+        ::operator delete(chunks[current].data);
+        chunks.erase(chunks.begin() + current);
+      } else
+        ++current;
+    }
+    if (current == chunks.size()) addChunk(n);
+  }
+
+  void *allocate() {
+    while (current < chunks.size() &&
+           chunks[current].used == chunks[current].capacity)
+      ++current;
+    if (current == chunks.size())
+      addChunk(count > minimumChunk ? count : minimumChunk);
+    chunk &c = chunks[current];
+    ++count;
+    return c.data + c.used++;
+  }
+
+  // gives back the last slot when its constructor threw
+  void discard(void *p) {
+    chunk &c = chunks[current];
+    if (c.used != 0 && p == c.data + c.used - 1) {
+      --c.used;
+      --count;
+    }
+  }
+
+  void clear() {
+    for (unsigned i = 0; i < chunks.size(); ++i) {
+      for (int j = 0; j < chunks[i].used; ++j) chunks[i].data[j].~T();
+      chunks[i].used = 0;
+    }
+    current = 0;
+    count = 0;
+  }
+
+  void release() {
+    clear();
+    for (unsigned i = 0; i < chunks.size(); ++i)
+      ::operator delete(chunks[i].data);
+    chunks.clear();
+  }
+
+  int size() const { return count; }
+
+ private:
+  struct chunk {
+    T *data;
+    int capacity;
+    int used;
+  };
+
+  static const int minimumChunk = 1024;
+
+  void addChunk(int capacity) {
+    chunk c;
+    c.data = static_cast<T *>(::operator new(sizeof(T) * capacity));
+    c.capacity = capacity;
+    c.used = 0;
+    chunks.push_back(c);
+  }
+
+  std::vector<chunk> chunks;
+  unsigned current;
+  int count;
+};
+
+template <typename T>
+inline void *operator new(std::size_t, elementArena<T> &arena) {
+  return arena.allocate();
+}
+
+template <typename T>
+inline void operator delete(void *p, elementArena<T> &arena) {
+  arena.discard(p);
+}
+
+#endif  // ELEMENTARENA_H
@@ -6,6 +6,7 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "networkgraph.h"
 #include "tools.h"
 
 using namespace std;
@@ -43,16 +44,13 @@ void network::setupRegularModel() {
 }
 
 void network::createNodes() {
-  tableOfNodes.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfNodes[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfNodes[i][j].resize(Nz);
-  }
+  tableOfNodes.resize(Nx, Ny, Nz, 0);
+  nodeArena.reserve(Nx * Ny * Nz);
   for (int i = 0; i < Nx; ++i)
     for (int j = 0; j < Ny; ++j)
       for (int k = 0; k < Nz; ++k) {
-        tableOfNodes[i][j][k] = new node(i, j, k);
-        tableOfAllNodes.push_back(tableOfNodes[i][j][k]);
+        tableOfNodes(i, j, k) = new (nodeArena) node(i, j, k);
+        tableOfAllNodes.push_back(tableOfNodes(i, j, k));
       }
 
   totalNodes = Nx * Ny * Nz;
@@ -75,54 +73,41 @@ void network::createNodes() {
 }
 
 void network::createPores() {
-  tableOfPoresX.resize(Nx + 1);
-  for (int i = 0; i < Nx + 1; ++i) {
-    tableOfPoresX[i].resize(Ny + 1);
-    for (int j = 0; j < Ny; ++j) tableOfPoresX[i][j].resize(Nz);
-  }
-
-  tableOfPoresY.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresY[i].resize(Ny + 1);
-    for (int j = 0; j < Ny + 1; ++j) tableOfPoresY[i][j].resize(Nz);
-  }
-
-  tableOfPoresZ.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresZ[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfPoresZ[i][j].resize(Nz + 1);
-  }
+  tableOfPoresX.resize(Nx + 1, Ny, Nz, 0);
+  tableOfPoresY.resize(Nx, Ny + 1, Nz, 0);
+  tableOfPoresZ.resize(Nx, Ny, Nz + 1, 0);
+  poreArena.reserve(3 * Nx * Ny * Nz + Ny * Nz + Nx * Nz + Nx * Ny);
 
   for (int i = 0; i < Nx + 1; ++i)
     for (int j = 0; j < Ny; ++j)
       for (int k = 0; k < Nz; ++k)
-        tableOfPoresX[i][j][k] =
-            new pore(getNode(i, j, k), getNode(i - 1, j, k));
+        tableOfPoresX(i, j, k) =
+            new (poreArena) pore(getNode(i, j, k), getNode(i - 1, j, k));
   for (int i = 0; i < Nx; ++i)
     for (int j = 0; j < Ny + 1; ++j)
       for (int k = 0; k < Nz; ++k)
-        tableOfPoresY[i][j][k] =
-            new pore(getNode(i, j, k), getNode(i, j - 1, k));
+        tableOfPoresY(i, j, k) =
+            new (poreArena) pore(getNode(i, j, k), getNode(i, j - 1, k));
   for (int i = 0; i < Nx; ++i)
     for (int j = 0; j < Ny; ++j)
       for (int k = 0; k < Nz + 1; ++k)
-        tableOfPoresZ[i][j][k] =
-            new pore(getNode(i, j, k), getNode(i, j, k - 1));
+        tableOfPoresZ(i, j, k) =
+            new (poreArena) pore(getNode(i, j, k), getNode(i, j, k - 1));
 
   totalPores = 3 * Nx * Ny * Nz + Ny * Nz + Nx * Nz + Nx * Ny;
 
   for (int k = 0; k < Nz; ++k)
     for (int j = 0; j < Ny; ++j)
       for (int i = 0; i < Nx + 1; ++i)
-        tableOfAllPores.push_back(tableOfPoresX[i][j][k]);
+        tableOfAllPores.push_back(tableOfPoresX(i, j, k));
   for (int k = 0; k < Nz; ++k)
     for (int j = 0; j < Ny + 1; ++j)
       for (int i = 0; i < Nx; ++i)
-        tableOfAllPores.push_back(tableOfPoresY[i][j][k]);
+        tableOfAllPores.push_back(tableOfPoresY(i, j, k));
   for (int k = 0; k < Nz + 1; ++k)
     for (int j = 0; j < Ny; ++j)
       for (int i = 0; i < Nx; ++i)
-        tableOfAllPores.push_back(tableOfPoresZ[i][j][k]);
+        tableOfAllPores.push_back(tableOfPoresZ(i, j, k));
 
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -164,24 +149,6 @@ void network::setNeighboors() {
                                                 : zout->getNodeIn()->getId());
     n->setNeighboors(neighboors);
   }
-
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-    p->setNeighboors(neighboors);
-  }
 }
 
 void network::setNeighboorsForEntireNetwork() {
@@ -211,25 +178,6 @@ void network::setNeighboorsForEntireNetwork() {
     if (connectionNumber > maxConnectionNumber)
       maxConnectionNumber = connectionNumber;
   }
-
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
-    }
-
-    p->setNeighboors(neighboors);
-  }
 }
 
 void network::applyCoordinationNumber() {
@@ -469,6 +417,11 @@ void network::assignViscosities() {
 }
 
 void network::updateRanking() {
+  if (nodeReordering) {
+    updateRankingWithCuthillMcKee();
+    return;
+  }
+
   int rank = 0;
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
@@ -479,24 +432,55 @@ void network::updateRanking() {
   }
 }
 
-void network::setNeighboorsForGenericModel() {
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    vector<pore*> neighboors;
-    if (p->getNodeIn() != 0) {
-      const vector<int>& neighboorsIn = p->getNodeIn()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsIn.size(); ++j)
-        if (neighboorsIn[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsIn[j] - 1));
-    }
-    if (p->getNodeOut() != 0) {
-      const vector<int>& neighboorsOut = p->getNodeOut()->getConnectedPores();
-      for (unsigned j = 0; j < neighboorsOut.size(); ++j)
-        if (neighboorsOut[j] != p->getId())
-          neighboors.push_back(getPore(neighboorsOut[j] - 1));
+// Reverse Cuthill-McKee ranking: each connected part of the network is
+// numbered breadth-first from a node of lowest degree, visiting neighboors by
+// increasing degree, and the numbering is reversed. Connected nodes get close
+// ranks, which narrows the band of the conductivity matrix.
+void network::updateRankingWithCuthillMcKee() {
+  updateNetworkGraph();
+  const networkGraph& graph = *nodePores;
+
+  vector<vector<int> > adjacency(totalNodes);
+  vector<int> candidates;
+  for (int i = 0; i < totalNodes; ++i) {
+    if (getNode(i)->getClosed()) continue;
+    candidates.push_back(i);
+    for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j) {
+      pore* p = getPore(graph.pores[j]);
+      if (p->getClosed() || p->getInlet() || p->getOutlet()) continue;
+      node* neighboor = graph.signs[j] > 0 ? p->getNodeOut() : p->getNodeIn();
+      if (!neighboor->getClosed())
+        adjacency[i].push_back(neighboor->getId() - 1);
+    }
+  }
+
+  auto lowerDegree = [&adjacency](int a, int b) {
+    return adjacency[a].size() < adjacency[b].size();
+  };
+  stable_sort(candidates.begin(), candidates.end(), lowerDegree);
+
+  vector<int> order;
+  order.reserve(candidates.size());
+  vector<char> visited(totalNodes, 0);
+  for (unsigned i = 0; i < candidates.size(); ++i) {
+    if (visited[candidates[i]]) continue;
+    visited[candidates[i]] = 1;
+    order.push_back(candidates[i]);
+    for (unsigned head = order.size() - 1; head < order.size(); ++head) {
+      unsigned first = order.size();
+      const vector<int>& neighboors = adjacency[order[head]];
+      for (unsigned j = 0; j < neighboors.size(); ++j)
+        if (!visited[neighboors[j]]) {
+          visited[neighboors[j]] = 1;
+          order.push_back(neighboors[j]);
+        }
+      stable_sort(order.begin() + first, order.end(), lowerDegree);
     }
-    p->setNeighboors(neighboors);
   }
+
+  int rank = order.size();
+  for (unsigned i = 0; i < order.size(); ++i)
+    getNode(order[i])->setRank(--rank);
 }
 
 void network::cleanGenericNetwork() {
@@ -544,14 +528,7 @@ void network::cleanGenericNetwork() {
   }
 
   // Update the ranking for the solver
-  int rank = 0;
-  for (int i = 0; i < totalNodes; ++i) {
-    node* n = getNode(i);
-    if (!n->getClosed()) {
-      n->setRank(rank);
-      rank++;
-    }
-  }
+  updateRanking();
 }
 
 void network::generateTissue() {
@@ -567,10 +544,14 @@ void network::generateTissue() {
   double hy = yEdgeLength / meshSizeY;
   double hz = zEdgeLength / meshSizeZ;
 
+  tableOfBlocks.resize(meshSizeX, meshSizeY, meshSizeZ, 0);
+  blockArena.reserve(meshSizeX * meshSizeY * meshSizeZ);
   for (int i = 0; i < meshSizeX; ++i)
     for (int j = 0; j < meshSizeY; ++j)
-      for (int k = 0; k < meshSizeZ; ++k)
-        tableOfAllBlocks.push_back(new block(i, j, k));
+      for (int k = 0; k < meshSizeZ; ++k) {
+        tableOfBlocks(i, j, k) = new (blockArena) block(i, j, k);
+        tableOfAllBlocks.push_back(tableOfBlocks(i, j, k));
+      }
 
   totalBlocks = meshSizeX * meshSizeY * meshSizeZ;
 
@@ -591,8 +572,6 @@ void network::generateTissue() {
     n->setHz(hz);
     n->setVolume(hx * hy * hz);
     n->setEffectiveVolume(n->getVolume());
-
-    tableOfAllBlocks.push_back(n);
   }
 
   cout << "Generating Tissue Neighboors..." << endl;
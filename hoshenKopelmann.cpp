@@ -58,11 +58,15 @@ void network::clusterPores(cluster* (pore::*getter)(void)const,
     pore* p = getPore(i);
     if ((p->*status)() == flag) {
       vector<int> neighboorsClusters;
-      vector<pore*> neighboors = p->getNeighboors();
-      for (unsigned j = 0; j < neighboors.size(); j++) {
-        if ((neighboors[j]->*status)() == flag &&
-            neighboors[j]->getClusterTemp() != 0)
-          neighboorsClusters.push_back(neighboors[j]->getClusterTemp());
+      node* ends[2] = {p->getNodeIn(), p->getNodeOut()};
+      for (int e = 0; e < 2; ++e) {
+        if (ends[e] == 0) continue;
+        const vector<int>& neighboors = ends[e]->getConnectedPores();
+        for (unsigned j = 0; j < neighboors.size(); j++) {
+          pore* pp = getPore(neighboors[j] - 1);
+          if (pp != p && (pp->*status)() == flag && pp->getClusterTemp() != 0)
+            neighboorsClusters.push_back(pp->getClusterTemp());
+        }
       }
       if (neighboorsClusters.empty())
         p->setClusterTemp(hkMakeSet(labels));
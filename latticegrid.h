@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef LATTICEGRID_H
+#define LATTICEGRID_H
+
+#include <vector>
+
+// Contiguous 3D table of lattice elements with k as the fastest index. The
+// table is padded with one ghost layer on every side: (i, j, k) may be read for
+// -1 <= i <= nx, -1 <= j <= ny and -1 <= k <= nz, and the ghost cells keep the
+// value given to resize (0 for element tables). Stencils can then address the
+// six neighbours of an interior cell c as c -/+ getStrideX(), c -/+
+// getStrideY() and c -/+ 1 without bounds checks.
+template <typename T>
+class latticeGrid {
+ public:
+  latticeGrid() : nx(0), ny(0), nz(0) {}
+
+  void resize(int nx, int ny, int nz, const T &value = T()) {
+    this->nx = nx;
+    this->ny = ny;
+    this->nz = nz;
+    cells.assign((nx + 2) * (ny + 2) * (nz + 2), value);
+  }
+
+  void clear() {
+    nx = ny = nz = 0;
+    cells.clear();
+  }
+
+  bool contains(int i, int j, int k) const {
+    return i >= 0 && i < nx && j >= 0 && j < ny && k >= 0 && k < nz;
+  }
+
+  int index(int i, int j, int k) const {
+    return ((i + 1) * (ny + 2) + j + 1) * (nz + 2) + k + 1;
+  }
+
+  T &operator()(int i, int j, int k) { return cells[index(i, j, k)]; }
+  const T &operator()(int i, int j, int k) const {
+    return cells[index(i, j, k)];
+  }
+
+  T &operator[](int index) { return cells[index]; }
+  const T &operator[](int index) const { return cells[index]; }
+
+  int getStrideX() const { return (ny + 2) * (nz + 2); }
+  int getStrideY() const { return nz + 2; }
+
+  int getNx() const { return nx; }
+  int getNy() const { return ny; }
+  int getNz() const { return nz; }
+
+ private:
+  int nx;
+  int ny;
+  int nz;
+  std::vector<T> cells;
+};
+
+#endif  // LATTICEGRID_H
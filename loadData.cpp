@@ -41,6 +41,7 @@ void network::loadNetworkData() {
   length = pt.get<double>("Geometry.length") * 1e-6;
   seed = pt.get<int>("Geometry.seed");
   solverChoice = pt.get<int>("Geometry.solverChoice");
+  nodeReordering = pt.get<bool>("Geometry.nodeReordering");
   absolutePermeabilityCalculation =
       pt.get<bool>("Geometry.absolutePermeabilityCalculation");
   extractData = pt.get<bool>("Geometry.extractData");
@@ -76,6 +77,10 @@ void network::loadTwoPhaseData() {
   bolusDuration = pt.get<double>("Drug.bolusDuration");
   bolusInjection = pt.get<bool>("Drug.bolusInjection");
   AIFInjection = pt.get<bool>("Drug.AIFInjection");
+  implicitTransport = pt.get<bool>("Drug.implicitTransport");
+  implicitTimeStep = pt.get<double>("Drug.implicitTimeStep");
+  timeStepLevels = pt.get<int>("Drug.timeStepLevels");
+  impulseResponse = pt.get<bool>("Drug.impulseResponse");
 
   PVT = pt.get<double>("Tissue.PVT");
   DT = pt.get<double>("Tissue.DT");
@@ -88,6 +93,8 @@ void network::loadTwoPhaseData() {
   tissueCircularY = pt.get<double>("Tissue.tissueCircularY");
   tissueCircularZ = pt.get<double>("Tissue.tissueCircularZ");
   closedBoundaries = pt.get<bool>("Tissue.closedBoundaries");
+  implicitDiffusion = pt.get<bool>("Tissue.implicitDiffusion");
+  tissueEnsemble = pt.get<bool>("Tissue.tissueEnsemble");
 
   injectParticles = pt.get<bool>("Particles.injectParticles");
   injectionInterval = pt.get<double>("Particles.injectionInterval");
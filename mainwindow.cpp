@@ -127,7 +127,10 @@ void MainWindow::exportNetworkDataFromGUI() {
   int solverChoice;
   if (ui->choleskyRadioButton->isChecked()) solverChoice = 1;
   if (ui->bicstabRadioButton->isChecked()) solverChoice = 2;
+  if (ui->pcgRadioButton->isChecked()) solverChoice = 3;
+  if (ui->multigridRadioButton->isChecked()) solverChoice = 4;
   settings.setValue("solverChoice", solverChoice);
+  settings.setValue("nodeReordering", ui->reorderNodesCheckBox->isChecked());
   settings.setValue("absolutePermeabilityCalculation",
                     ui->calcPermCheckBox->isChecked());
   settings.setValue("extractData", ui->extractDataCheckBox->isChecked());
@@ -181,6 +184,12 @@ void MainWindow::exportTwoPhaseDataFromGUI() {
   settings.setValue("bolusDuration",
                     ui->twoPhasePrecisionFactorLineEdit->text());
   settings.setValue("AIFInjection", ui->AIFRadioButton->isChecked());
+  settings.setValue("implicitTransport",
+                    ui->implicitTransportCheckBox->isChecked());
+  settings.setValue("implicitTimeStep", ui->implicitTimeStepLineEdit->text());
+  settings.setValue("timeStepLevels", ui->timeStepLevelsLineEdit->text());
+  settings.setValue("impulseResponse",
+                    ui->impulseResponseCheckBox->isChecked());
   settings.endGroup();
 
   settings.beginGroup("Tissue");
@@ -195,6 +204,8 @@ void MainWindow::exportTwoPhaseDataFromGUI() {
   settings.setValue("tissueCircularY", ui->tissueCircularY->text());
   settings.setValue("tissueCircularZ", ui->tissueCircularZ->text());
   settings.setValue("closedBoundaries", ui->closedBoundaries->isChecked());
+  settings.setValue("implicitDiffusion", ui->implicitDiffusion->isChecked());
+  settings.setValue("tissueEnsemble", ui->tissueEnsemble->isChecked());
   settings.endGroup();
 
   settings.beginGroup("Particles");
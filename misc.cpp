@@ -6,7 +6,10 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "particlepool.h"
+#include "snapshotwriter.h"
 #include "tools.h"
+#include "trajectorywriter.h"
 
 #include <boost/lexical_cast.hpp>
 #include <boost/random.hpp>
@@ -122,9 +125,7 @@ void network::initialiseSimulation() {
     }
   }
 
-  for (int i = 0; i < totalParticles; ++i) delete tableOfParticles[i];
-
-  tableOfParticles.clear();
+  particles->clear();
   totalParticles = 0;
 
   cancel = false;
@@ -135,51 +136,47 @@ void network::extractDrugFlowResults(double timeElapsed, double timeSoFar,
                                      double& simulationTimeElapsed,
                                      int& outputCount, bool forceExtraction) {
   if (timeElapsed > simulationTimeElapsed || forceExtraction) {
-    ofstream ofs1;
-    ofs1.open("Results/output.txt", ofstream::app);
-
-    ofs1 << outputCount << " " << timeSoFar << endl;
+    // the snapshot is copied here and written to disk by the snapshot thread
+    snapshotWriter::snapshot& s = snapshots->acquire();
+    s.outputCount = outputCount;
+    s.time = timeSoFar;
 
-    string path = "Results/Network_Status/conc_pores" +
-                  boost::lexical_cast<std::string>(1000000000 + outputCount) +
-                  ".txt";
-
-    ofstream file1(path.c_str());
+    s.poreIDs.clear();
+    s.poreConcentrations.clear();
     for (int i = 0; i < totalPores; ++i) {
       pore* p = getPore(i);
       if (!p->getClosed()) {
-        file1 << p->getId() << " " << p->getConcentration() << endl;
+        s.poreIDs.push_back(p->getId());
+        s.poreConcentrations.push_back(p->getConcentration());
       }
     }
 
-    if (networkSource == 2 || networkSource == 3) {
-      string path = "Results/Network_Status/conc_nodes" +
-                    boost::lexical_cast<std::string>(1000000000 + outputCount) +
-                    ".txt";
-      ofstream file2(path.c_str());
+    s.withNodes = networkSource == 2 || networkSource == 3;
+    s.nodeIDs.clear();
+    s.nodeConcentrations.clear();
+    if (s.withNodes)
       for (int i = 0; i < totalNodes; ++i) {
         node* n = getNode(i);
         if (!n->getClosed()) {
-          file2 << n->getId() << " " << n->getConcentration() << endl;
+          s.nodeIDs.push_back(n->getId());
+          s.nodeConcentrations.push_back(n->getConcentration());
         }
       }
-    }
 
-    path = "Results/Network_Status/conc_blocks" +
-           boost::lexical_cast<std::string>(1000000000 + outputCount) + ".txt";
-
-    ofstream file3(path.c_str());
+    s.blockIDs.clear();
+    s.blockConcentrations.clear();
     for (int i = 0; i < totalBlocks; ++i) {
       block* p = getBlock(i);
       if (!p->getClosed()) {
-        file3 << p->getId() << " " << p->getConcentration() << endl;
+        s.blockIDs.push_back(p->getId());
+        s.blockConcentrations.push_back(p->getConcentration());
       }
     }
 
+    snapshots->submit();
+
     simulationTimeElapsed += extractionTimestep;
     outputCount++;
-
-    ofs1.close();
   }
 }
 
@@ -211,22 +208,10 @@ void network::extractParticleFlowResults(double timeElapsed, double timeSoFar,
     //        outputCount++;
 
     //        ofs1.close();
-    ofstream ofs1;
-    ofs1.open("Results/particleData.txt", ofstream::app);
-
-    for (int i = 0; i < totalParticles; ++i) {
-      particle* p = getParticle(i);
-      if (!p->getClosed()) {
-        ofs1 << outputCount << "\t" << timeSoFar << "\t" << p->getId() << "\t"
-             << p->getXCoordinate() * 1e6 << "\t" << p->getYCoordinate() * 1e6
-             << "\t" << p->getZCoordinate() * 1e6 << endl;
-      }
-    }
+    trajectories->write(outputCount, timeSoFar, *particles);
 
     simulationTimeElapsed += extractionTimestep;
     outputCount++;
-
-    ofs1.close();
   }
 }
 
@@ -236,29 +221,29 @@ void network::setConstantFlowRateAker() {
 
   assignConductivities();
 
-  double Q1(0), Q2(0), A, B;
+  solveForFlowRate(flowRate);
+}
 
+double network::solveForFlowRate(double targetQ) {
+  // with pressureOut=0 the pressure field is linear in pressureIn: a single
+  // unit pressure solve is rescaled to match the target flow rate
   pressureIn = 1;
   pressureOut = 0;
   solvePressures();
-  updateFlows();
-  Q1 = getOutletFlow();
-
-  pressureIn = 2;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q2 = getOutletFlow();
-
-  B = (Q1 - Q2 * 1 / 2) / (1 - 1 / 2);
-  A = (Q1 - B);
-
-  deltaP = flowRate / A - B / A;
+  double unitQ = updateFlows();
 
+  deltaP = targetQ / unitQ;
   pressureIn = deltaP;
   pressureOut = 0;
-  solvePressures();
+
+  for (int i = 0; i < totalNodes; ++i) {
+    node* n = getNode(i);
+    if (!n->getClosed()) n->setPressure(n->getPressure() * deltaP);
+  }
+  solvedPressureIn = deltaP;
   updateFlows();
+
+  return deltaP;
 }
 
 void network::setConstantFlowRateSecant(std::set<pore*>& poresToClose) {
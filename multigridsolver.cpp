@@ -0,0 +1,302 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "multigridsolver.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+multigridSolver::multigridSolver() {
+  tolerance = 1e-10;
+  maxIterations = 500;
+  iterations = 0;
+  error = 0;
+}
+
+void multigridSolver::setup(int nx, int ny, int nz, const vector<double> &cx,
+                            const vector<double> &cy, const vector<double> &cz,
+                            const vector<double> &sink,
+                            const vector<char> &live) {
+  // the aggregates only depend on the lattice and its open nodes, so they are
+  // kept across solves and only the coarse operators follow the conductivities
+  if (levels.empty() || levels[0].nx != nx || levels[0].ny != ny ||
+      levels[0].nz != nz || levels[0].live != live)
+    aggregate(nx, ny, nz, live);
+
+  level &fine = levels[0];
+  fine.cx = cx;
+  fine.cy = cy;
+  fine.cz = cz;
+
+  fine.diag.assign(nx * ny * nz, 0);
+  for (int k = 0; k < nz; ++k)
+    for (int j = 0; j < ny; ++j)
+      for (int i = 0; i < nx; ++i) {
+        int idx = i + nx * (j + ny * k);
+        if (!live[idx]) continue;
+        double d = sink[idx] + cx[idx] + cy[idx] + cz[idx];
+        if (i > 0) d += cx[idx - 1];
+        if (j > 0) d += cy[idx - nx];
+        if (k > 0) d += cz[idx - nx * ny];
+        fine.diag[idx] = d;
+      }
+
+  for (unsigned i = 1; i < levels.size(); ++i)
+    coarsen(levels[i - 1], levels[i]);
+}
+
+void multigridSolver::aggregate(int nx, int ny, int nz,
+                                const vector<char> &live) {
+  levels.clear();
+  levels.push_back(level());
+
+  level &fine = levels[0];
+  fine.nx = nx;
+  fine.ny = ny;
+  fine.nz = nz;
+  fine.live = live;
+
+  // coarsen until the grid is small enough for plain smoothing
+  while (levels.back().nx * levels.back().ny * levels.back().nz > 64 &&
+         (levels.back().nx > 1 || levels.back().ny > 1 ||
+          levels.back().nz > 1)) {
+    level &l = levels.back();
+    level coarse;
+    coarse.nx = (l.nx + 1) / 2;
+    coarse.ny = (l.ny + 1) / 2;
+    coarse.nz = (l.nz + 1) / 2;
+    coarse.live.assign(coarse.nx * coarse.ny * coarse.nz, 0);
+
+    l.parent.assign(l.nx * l.ny * l.nz, -1);
+    for (int k = 0; k < l.nz; ++k)
+      for (int j = 0; j < l.ny; ++j)
+        for (int i = 0; i < l.nx; ++i) {
+          int idx = i + l.nx * (j + l.ny * k);
+          if (!l.live[idx]) continue;
+          int cidx = i / 2 + coarse.nx * (j / 2 + coarse.ny * (k / 2));
+          l.parent[idx] = cidx;
+          coarse.live[cidx] = 1;
+        }
+    levels.push_back(coarse);
+  }
+
+  for (unsigned i = 0; i < levels.size(); ++i) {
+    level &l = levels[i];
+    int size = l.nx * l.ny * l.nz;
+    l.x.assign(size, 0);
+    l.b.assign(size, 0);
+    l.r.assign(size, 0);
+  }
+}
+
+void multigridSolver::coarsen(const level &fine, level &coarse) {
+  int size = coarse.nx * coarse.ny * coarse.nz;
+  coarse.cx.assign(size, 0);
+  coarse.cy.assign(size, 0);
+  coarse.cz.assign(size, 0);
+  coarse.diag.assign(size, 0);
+
+  // fine sink = diag minus the face conductivities
+  for (int k = 0; k < fine.nz; ++k)
+    for (int j = 0; j < fine.ny; ++j)
+      for (int i = 0; i < fine.nx; ++i) {
+        int idx = i + fine.nx * (j + fine.ny * k);
+        int cidx = fine.parent[idx];
+        if (cidx < 0) continue;
+
+        double sink = fine.diag[idx] - fine.cx[idx] - fine.cy[idx] -
+                      fine.cz[idx];
+        if (i > 0) sink -= fine.cx[idx - 1];
+        if (j > 0) sink -= fine.cy[idx - fine.nx];
+        if (k > 0) sink -= fine.cz[idx - fine.nx * fine.ny];
+        coarse.diag[cidx] += sink;
+
+        // only faces crossing an aggregate boundary survive
+        if (i % 2 == 1 && i < fine.nx - 1) coarse.cx[cidx] += fine.cx[idx];
+        if (j % 2 == 1 && j < fine.ny - 1) coarse.cy[cidx] += fine.cy[idx];
+        if (k % 2 == 1 && k < fine.nz - 1) coarse.cz[cidx] += fine.cz[idx];
+      }
+
+  for (int k = 0; k < coarse.nz; ++k)
+    for (int j = 0; j < coarse.ny; ++j)
+      for (int i = 0; i < coarse.nx; ++i) {
+        int idx = i + coarse.nx * (j + coarse.ny * k);
+        if (!coarse.live[idx]) continue;
+        double d = coarse.cx[idx] + coarse.cy[idx] + coarse.cz[idx];
+        if (i > 0) d += coarse.cx[idx - 1];
+        if (j > 0) d += coarse.cy[idx - coarse.nx];
+        if (k > 0) d += coarse.cz[idx - coarse.nx * coarse.ny];
+        coarse.diag[idx] += d;
+      }
+}
+
+void multigridSolver::applyOperator(const level &l, const vector<double> &x,
+                                    vector<double> &y) const {
+  int nx = l.nx, ny = l.ny, nz = l.nz;
+  int nxy = nx * ny;
+  for (int k = 0; k < nz; ++k)
+    for (int j = 0; j < ny; ++j)
+      for (int i = 0; i < nx; ++i) {
+        int idx = i + nx * (j + ny * k);
+        if (!l.live[idx]) {
+          y[idx] = 0;
+          continue;
+        }
+        double value = l.diag[idx] * x[idx];
+        if (i > 0) value -= l.cx[idx - 1] * x[idx - 1];
+        if (i < nx - 1) value -= l.cx[idx] * x[idx + 1];
+        if (j > 0) value -= l.cy[idx - nx] * x[idx - nx];
+        if (j < ny - 1) value -= l.cy[idx] * x[idx + nx];
+        if (k > 0) value -= l.cz[idx - nxy] * x[idx - nxy];
+        if (k < nz - 1) value -= l.cz[idx] * x[idx + nxy];
+        y[idx] = value;
+      }
+}
+
+void multigridSolver::smooth(level &l, int color) {
+  int nx = l.nx, ny = l.ny, nz = l.nz;
+  int nxy = nx * ny;
+  vector<double> &x = l.x;
+  for (int k = 0; k < nz; ++k)
+    for (int j = 0; j < ny; ++j)
+      for (int i = (j + k + color) % 2; i < nx; i += 2) {
+        int idx = i + nx * (j + ny * k);
+        if (!l.live[idx] || l.diag[idx] == 0) continue;
+        double value = l.b[idx];
+        if (i > 0) value += l.cx[idx - 1] * x[idx - 1];
+        if (i < nx - 1) value += l.cx[idx] * x[idx + 1];
+        if (j > 0) value += l.cy[idx - nx] * x[idx - nx];
+        if (j < ny - 1) value += l.cy[idx] * x[idx + nx];
+        if (k > 0) value += l.cz[idx - nxy] * x[idx - nxy];
+        if (k < nz - 1) value += l.cz[idx] * x[idx + nxy];
+        x[idx] = value / l.diag[idx];
+      }
+}
+
+void multigridSolver::vCycle(unsigned depth) {
+  level &l = levels[depth];
+  fill(l.x.begin(), l.x.end(), 0.0);
+
+  // red-black sweeps before and black-red sweeps after the coarse correction
+  // keep the cycle symmetric, as required by the conjugate gradient
+  if (depth == levels.size() - 1) {
+    for (int sweep = 0; sweep < 20; ++sweep) {
+      smooth(l, 0);
+      smooth(l, 1);
+    }
+    for (int sweep = 0; sweep < 20; ++sweep) {
+      smooth(l, 1);
+      smooth(l, 0);
+    }
+    return;
+  }
+
+  smooth(l, 0);
+  smooth(l, 1);
+  smooth(l, 0);
+  smooth(l, 1);
+
+  applyOperator(l, l.x, l.r);
+  for (unsigned i = 0; i < l.r.size(); ++i) l.r[i] = l.b[i] - l.r[i];
+
+  level &c = levels[depth + 1];
+  fill(c.b.begin(), c.b.end(), 0.0);
+  for (unsigned i = 0; i < l.parent.size(); ++i)
+    if (l.parent[i] >= 0) c.b[l.parent[i]] += l.r[i];
+
+  vCycle(depth + 1);
+
+  for (unsigned i = 0; i < l.parent.size(); ++i)
+    if (l.parent[i] >= 0) l.x[i] += c.x[l.parent[i]];
+
+  smooth(l, 1);
+  smooth(l, 0);
+  smooth(l, 1);
+  smooth(l, 0);
+}
+
+void multigridSolver::solve(const vector<double> &b, vector<double> &x) {
+  iterations = 0;
+  error = 0;
+  if (levels.empty()) return;
+
+  level &fine = levels[0];
+  int size = fine.nx * fine.ny * fine.nz;
+  if (int(x.size()) != size) x.assign(size, 0);
+
+  vector<double> r(size), z(size), p(size), q(size);
+
+  applyOperator(fine, x, q);
+  double normB(0);
+  for (int i = 0; i < size; ++i) {
+    if (!fine.live[i]) x[i] = 0;
+    r[i] = fine.live[i] ? b[i] - q[i] : 0;
+    normB += b[i] * b[i];
+  }
+  normB = sqrt(normB);
+  if (normB == 0) {
+    fill(x.begin(), x.end(), 0.0);
+    return;
+  }
+
+  double normR(0);
+  for (int i = 0; i < size; ++i) normR += r[i] * r[i];
+  error = sqrt(normR) / normB;
+  if (error < tolerance) return;
+
+  fine.b = r;
+  vCycle(0);
+  z = fine.x;
+  p = z;
+  double rz(0);
+  for (int i = 0; i < size; ++i) rz += r[i] * z[i];
+
+  while (iterations < maxIterations) {
+    applyOperator(fine, p, q);
+    double pq(0);
+    for (int i = 0; i < size; ++i) pq += p[i] * q[i];
+    double alpha = rz / pq;
+
+    normR = 0;
+    for (int i = 0; i < size; ++i) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+      normR += r[i] * r[i];
+    }
+    iterations++;
+    error = sqrt(normR) / normB;
+    if (error < tolerance) break;
+
+    fine.b = r;
+    vCycle(0);
+    z = fine.x;
+
+    double rzNew(0);
+    for (int i = 0; i < size; ++i) rzNew += r[i] * z[i];
+    double beta = rzNew / rz;
+    rz = rzNew;
+    for (int i = 0; i < size; ++i) p[i] = z[i] + beta * p[i];
+  }
+}
+
+void multigridSolver::clear() { levels.clear(); }
+
+double multigridSolver::getTolerance() const { return tolerance; }
+
+void multigridSolver::setTolerance(double value) { tolerance = value; }
+
+int multigridSolver::getMaxIterations() const { return maxIterations; }
+
+void multigridSolver::setMaxIterations(int value) { maxIterations = value; }
+
+int multigridSolver::getLevels() const { return levels.size(); }
+
+int multigridSolver::getIterations() const { return iterations; }
+
+double multigridSolver::getError() const { return error; }
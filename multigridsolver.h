@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef MULTIGRIDSOLVER_H
+#define MULTIGRIDSOLVER_H
+
+#include <vector>
+
+// Matrix-free geometric multigrid for the pressure field of a regular
+// Nx x Ny x Nz lattice. Cells are indexed i + Nx * (j + Ny * k); cx/cy/cz hold
+// the conductivity between a cell and its +x/+y/+z neighbour and sink the
+// conductivity towards fixed pressure boundaries. Coarse levels aggregate
+// 2x2x2 cells and sum the conductivities crossing the coarse faces, which is
+// the Galerkin operator of a piecewise constant prolongation. The aggregates
+// are kept while the lattice and its open cells stay the same. A symmetric
+// V-cycle preconditions a conjugate gradient iteration.
+class multigridSolver {
+ public:
+  multigridSolver();
+
+  void setup(int nx, int ny, int nz, const std::vector<double> &cx,
+             const std::vector<double> &cy, const std::vector<double> &cz,
+             const std::vector<double> &sink, const std::vector<char> &live);
+  void solve(const std::vector<double> &b, std::vector<double> &x);
+  void clear();
+
+  double getTolerance() const;
+  void setTolerance(double value);
+
+  int getMaxIterations() const;
+  void setMaxIterations(int value);
+
+  int getLevels() const;
+  int getIterations() const;
+  double getError() const;
+
+ private:
+  struct level {
+    int nx, ny, nz;
+    std::vector<double> cx, cy, cz, diag;
+    std::vector<char> live;
+    std::vector<int> parent;  // coarse cell of each live cell, -1 otherwise
+    std::vector<double> x, b, r;
+  };
+
+  void aggregate(int nx, int ny, int nz, const std::vector<char> &live);
+  void coarsen(const level &fine, level &coarse);
+  void applyOperator(const level &l, const std::vector<double> &x,
+                     std::vector<double> &y) const;
+  void smooth(level &l, int color);
+  void vCycle(unsigned depth);
+
+  std::vector<level> levels;
+
+  double tolerance;
+  int maxIterations;
+  int iterations;
+  double error;
+};
+
+#endif  // MULTIGRIDSOLVER_H
@@ -6,35 +6,61 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "aliastable.h"
+#include "diffusionstencil.h"
+#include "multigridsolver.h"
+#include "networkarrays.h"
+#include "networkgraph.h"
+#include "particlepool.h"
+#include "pressuresolver.h"
+#include "snapshotwriter.h"
+#include "tissuecoupling.h"
 #include "tools.h"
+#include "trajectorywriter.h"
 
 using namespace std;
 
-network::network(QObject *parent) : QObject(parent) { reset(); }
+network::network(QObject *parent) : QObject(parent) {
+  pressureSystem = new pressureSolver();
+  latticeSystem = new multigridSolver();
+  vesselArrays = new networkArrays();
+  nodePores = new networkGraph();
+  outflowRoutes = new aliasTable();
+  inletRoutes = new aliasTable();
+  particles = new particlePool();
+  trajectories = new trajectoryWriter();
+  snapshots = new snapshotWriter();
+  tissueExchange = new tissueCoupling();
+  tissueSystem = new pressureSolver();
+  tissueStencil = new diffusionStencil();
+  reset();
+}
 
 network::~network() {
-  for (int i = 0; i < totalPores; ++i) delete tableOfAllPores[i];
-
-  for (int i = 0; i < totalNodes; ++i) delete tableOfAllNodes[i];
-
-  for (int i = 0; i < totalBlocks; ++i) delete tableOfAllBlocks[i];
-
-  for (int i = 0; i < totalParticles; ++i) delete tableOfParticles[i];
-
   if (!existClusters.empty())
     for (unsigned i = 0; i < existClusters.size(); ++i) delete existClusters[i];
 
+  delete pressureSystem;
+  delete latticeSystem;
+  delete vesselArrays;
+  delete nodePores;
+  delete outflowRoutes;
+  delete inletRoutes;
+  delete particles;
+  delete trajectories;
+  delete snapshots;
+  delete tissueExchange;
+  delete tissueSystem;
+  delete tissueStencil;
+
   tools::cleanVideosFolder();
 }
 
 void network::destroy() {
-  for (int i = 0; i < totalPores; ++i) delete tableOfAllPores[i];
-
-  for (int i = 0; i < totalNodes; ++i) delete tableOfAllNodes[i];
-
-  for (int i = 0; i < totalBlocks; ++i) delete tableOfAllBlocks[i];
-
-  for (int i = 0; i < totalParticles; ++i) delete tableOfParticles[i];
+  // elements are released all at once, their memory is kept for the next model
+  poreArena.clear();
+  nodeArena.clear();
+  blockArena.clear();
 
   totalPores = 0;
   totalNodes = 0;
@@ -47,19 +73,35 @@ void network::destroy() {
   tableOfPoresX.clear();
   tableOfPoresY.clear();
   tableOfPoresZ.clear();
-  tableOfParticles.clear();
+  tableOfBlocks.clear();
+  particles->clear();
 
   if (!existClusters.empty())
     for (unsigned i = 0; i < existClusters.size(); ++i) delete existClusters[i];
 
   existClusters.clear();
 
+  pressureSystem->reset();
+  latticeSystem->clear();
+  vesselArrays->clear();
+  nodePores->clear();
+  outflowRoutes->clear();
+  inletRoutes->clear();
+  tissueExchange->clear();
+  tissueSystem->reset();
+  tissueStencil->clear();
+  impulseKey.clear();
+  impulseFlows.clear();
+
   tools::cleanVideosFolder();
 }
 
 void network::reset() {
   pressureIn = 1;
   pressureOut = 0;
+  solvedPressureIn = 0;
+  flowRoutesOutdated = true;
+  networkGraphOutdated = true;
 
   totalPores = 0;
   totalNodes = 0;
@@ -103,6 +145,9 @@ void network::setupModel() {
   if (networkSource == 5)  // parent vessel retina
     createRetinaParentVessels();
 
+  // Node-pore adjacency used by the simulations
+  buildNetworkGraph();
+
   // Build tissue
   if (buildTissue) generateTissue();
 
@@ -116,7 +161,12 @@ void network::runSimulation() {
   loadTwoPhaseData();
   if (drugFlowWithoutDiffusion && networkSource < 6)
     runDrugFlowWithoutDiffusion();
-  if (drugFlowWithDiffusion && networkSource < 6) runDrugFlowWithDiffusion();
+  if (drugFlowWithDiffusion && networkSource < 6) {
+    if (tissueEnsemble)
+      runDrugFlowEnsemble();
+    else
+      runDrugFlowWithDiffusion();
+  }
   if (particleFlow && networkSource < 6) runParticleFlow();
   if (angiogenesisTumour && networkSource == 4) runAngiogenesisOnLattice();
   if (angiogenesisRetina && networkSource == 5) runRetinaModel();
@@ -128,35 +178,35 @@ void network::emitPlotSignal() { emit plot(); }
 // getters
 pore *network::getPoreX(int i, int j, int k) const {
   if (i < 0 || i > Nx || j < 0 || j > Ny - 1 || k < 0 || k > Nz - 1) return 0;
-  return tableOfPoresX[i][j][k];
+  return tableOfPoresX(i, j, k);
 }
 
 pore *network::getPoreY(int i, int j, int k) const {
   if (i < 0 || i > Nx - 1 || j < 0 || j > Ny || k < 0 || k > Nz - 1) return 0;
-  return tableOfPoresY[i][j][k];
+  return tableOfPoresY(i, j, k);
 }
 
 pore *network::getPoreZ(int i, int j, int k) const {
   if (i < 0 || i > Nx - 1 || j < 0 || j > Ny - 1 || k < 0 || k > Nz) return 0;
-  return tableOfPoresZ[i][j][k];
+  return tableOfPoresZ(i, j, k);
 }
 
 pore *network::getPoreXout(int i, int j, int k) const {
   if (i < -1 || i > Nx - 1 || j < 0 || j > Ny - 1 || k < 0 || k > Nz - 1)
     return 0;
-  return tableOfPoresX[i + 1][j][k];
+  return tableOfPoresX(i + 1, j, k);
 }
 
 pore *network::getPoreYout(int i, int j, int k) const {
   if (i < 0 || i > Nx - 1 || j < -1 || j > Ny - 1 || k < 0 || k > Nz - 1)
     return 0;
-  return tableOfPoresY[i][j + 1][k];
+  return tableOfPoresY(i, j + 1, k);
 }
 
 pore *network::getPoreZout(int i, int j, int k) const {
   if (i < 0 || i > Nx - 1 || j < 0 || j > Ny - 1 || k < -1 || k > Nz - 1)
     return 0;
-  return tableOfPoresZ[i][j][k + 1];
+  return tableOfPoresZ(i, j, k + 1);
 }
 
 pore *network::getPore(int i) const {
@@ -167,7 +217,7 @@ pore *network::getPore(int i) const {
 node *network::getNode(int i, int j, int k) const {
   if (i < 0 || i > Nx - 1 || j < 0 || j > Ny - 1 || k < 0 || k > Nz - 1)
     return 0;
-  return tableOfNodes[i][j][k];
+  return tableOfNodes(i, j, k);
 }
 
 node *network::getNode(int i) const {
@@ -175,16 +225,11 @@ node *network::getNode(int i) const {
   return tableOfAllNodes[i];
 }
 
-particle *network::getParticle(int i) const {
-  if (i < 0 || i > totalParticles - 1) return 0;
-  return tableOfParticles[i];
-}
-
 block *network::getBlock(int i, int j, int k) const {
   if (i < 0 || i > meshSizeX - 1 || j < 0 || j > meshSizeY - 1 || k < 0 ||
       k > meshSizeZ - 1)
     return 0;
-  return tableOfAllBlocks[i * meshSizeY * meshSizeZ + j * meshSizeZ + k];
+  return tableOfBlocks(i, j, k);
 }
 
 block *network::getBlock(int i) const {
@@ -220,6 +265,7 @@ int network::getNz() const { return Nz; }
 void network::setNz(int value) { Nz = value; }
 
 int network::getTotalParticles() const { return totalParticles; }
+const particlePool &network::getParticlePool() const { return *particles; }
 int network::getNetworkSource() const { return networkSource; }
 
 bool network::getSimulationRunning() const { return simulationRunning; }
@@ -10,8 +10,9 @@
 
 #include "block.h"
 #include "cluster.h"
+#include "elementarena.h"
+#include "latticegrid.h"
 #include "node.h"
-#include "particle.h"
 #include "pore.h"
 
 #include <algorithm>
@@ -29,6 +30,17 @@
 
 using namespace std;
 
+class pressureSolver;
+class multigridSolver;
+struct networkArrays;
+struct networkGraph;
+struct aliasTable;
+struct particlePool;
+class trajectoryWriter;
+class snapshotWriter;
+struct tissueCoupling;
+struct diffusionStencil;
+
 class network : public QObject {
   Q_OBJECT
  public:
@@ -55,7 +67,7 @@ class network : public QObject {
   void setActiveElements();
   void assignViscosities();
   void updateRanking();
-  void setNeighboorsForGenericModel();
+  void updateRankingWithCuthillMcKee();
   void cleanGenericNetwork();
 
   ////Tissue
@@ -63,11 +75,23 @@ class network : public QObject {
   void tissueNetworkCollisionAnalysis();
   void tissueNetworkCollisionAnalysisRegular();
   void setupTissueProperties();
+  void buildTissueCoupling();
+  void prepareTissueStencil();
+  void setTissueStencilStep(double step);
 
   ////Simulations
   void runSimulation();
   void runDrugFlowWithoutDiffusion();
   void runDrugFlowWithDiffusion();
+  void runDrugFlowEnsemble();
+  void advectDrugExplicitly(double inletConcentration);
+  void advectDrugImplicitly(double inletConcentration);
+  void advectDrugMultirate(double time, double step, int substeps);
+  void averageDrugConcentrations(double &averageConc, double &outletConc);
+  double runDrugImpulseResponse(ofstream &outletFile, ofstream &averageFile);
+  double getDrugInletConcentration(double time);
+  double getDrugStepConcentration(double time);
+  void setFeedingVessels();
   void runParticleFlow();
   void runAngiogenesisOnLattice();
   void runStaticModelAdaptation();
@@ -128,11 +152,27 @@ class network : public QObject {
   /// Coupled Cell
   void runCoupledCell();
 
+  ////Structure of arrays
+  void buildNetworkGraph();
+  void updateNetworkGraph();
+  void buildFlowRoutes();
+  void updateFlowRoutes();
+  void gatherNetworkArrays();
+  void scatterConcentrations();
+  void gatherHaematocritArrays();
+  void scatterHaematocrit();
+
   ////Solvers and Permeabilities
   void solvePressures();
   void solvePressuresForRegularModel();
+  void solvePressuresWithMultigrid();
+  void assembleTissueDiffusion(double step);
+  void solveTissueDiffusion(double step, const std::vector<double> &sources,
+                            std::vector<double> &concentrations);
   double updateFlows();
   void calculatePermeabilityAndPorosity();
+  int getSolverIterations() const;
+  double getSolverError() const;
 
   ////Misc
 
@@ -161,6 +201,7 @@ class network : public QObject {
 
   // flow rate
   void setConstantFlowRateAker();
+  double solveForFlowRate(double);
   void setConstantFlowRateSecant(std::set<pore *> &);
   void massConservationCheck();
 
@@ -191,7 +232,6 @@ class network : public QObject {
   pore *getPore(int) const;
   node *getNode(int, int, int) const;
   node *getNode(int) const;
-  particle *getParticle(int) const;
   block *getBlock(int, int, int) const;
   block *getBlock(int) const;
 
@@ -218,6 +258,7 @@ class network : public QObject {
   int getNetworkSource() const;
   int getTotalOpenedNodes() const;
   int getTotalParticles() const;
+  const particlePool &getParticlePool() const;
   double getAbsolutePermeability() const;
   double getPorosity() const;
 
@@ -244,14 +285,17 @@ class network : public QObject {
   int Nx;
   int Ny;
   int Nz;
-  std::vector<std::vector<std::vector<node *> > > tableOfNodes;
-  std::vector<std::vector<std::vector<pore *> > > tableOfPoresX;
-  std::vector<std::vector<std::vector<pore *> > > tableOfPoresY;
-  std::vector<std::vector<std::vector<pore *> > > tableOfPoresZ;
+  latticeGrid<node *> tableOfNodes;
+  latticeGrid<pore *> tableOfPoresX;
+  latticeGrid<pore *> tableOfPoresY;
+  latticeGrid<pore *> tableOfPoresZ;
+  latticeGrid<block *> tableOfBlocks;
   std::vector<pore *> tableOfAllPores;
   std::vector<node *> tableOfAllNodes;
-  std::vector<particle *> tableOfParticles;
   std::vector<block *> tableOfAllBlocks;
+  elementArena<node> nodeArena;
+  elementArena<pore> poreArena;
+  elementArena<block> blockArena;
 
   int totalPores;
   int totalOpenedPores;
@@ -300,6 +344,22 @@ class network : public QObject {
 
   // solver
   int solverChoice;
+  bool nodeReordering;
+  pressureSolver *pressureSystem;
+  multigridSolver *latticeSystem;
+  networkArrays *vesselArrays;
+  networkGraph *nodePores;
+  bool networkGraphOutdated;
+  aliasTable *outflowRoutes;
+  aliasTable *inletRoutes;
+  bool flowRoutesOutdated;
+  particlePool *particles;
+  trajectoryWriter *trajectories;
+  snapshotWriter *snapshots;
+  tissueCoupling *tissueExchange;
+  pressureSolver *tissueSystem;
+  diffusionStencil *tissueStencil;
+  double solvedPressureIn;
 
   // perm Calc
   bool absolutePermeabilityCalculation;
@@ -343,11 +403,21 @@ class network : public QObject {
   double tissueCircularY;
   double tissueCircularZ;
   bool closedBoundaries;
+  bool implicitDiffusion;
+  bool tissueEnsemble;
 
   ////////////// Drug Data //////////////
   bool bolusInjection;
   double bolusDuration;
   bool AIFInjection;
+  bool implicitTransport;
+  double implicitTimeStep;
+  int timeStepLevels;
+  bool impulseResponse;
+  std::vector<double> impulseKey;
+  std::vector<double> impulseFlows;
+  std::vector<double> impulseOutlet;
+  std::vector<double> impulseAverage;
 
   ////////////// Artificial Network //////////////
   bool injectParticles;
@@ -0,0 +1,241 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "networkarrays.h"
+#include "network.h"
+
+using namespace std;
+
+void networkArrays::clear() {
+  poreIndex.clear();
+  poreNodeIn.clear();
+  poreNodeOut.clear();
+  poreInlet.clear();
+  poreOutlet.clear();
+  poreVesselType.clear();
+  poreFlow.clear();
+  poreVolume.clear();
+  poreConcentration.clear();
+  poreNextConcentration.clear();
+
+  poreLevel.clear();
+  poreInflowNode.clear();
+  poreInflowStart.clear();
+  nodeMixedConcentration.clear();
+  nodeInflowIntegral.clear();
+  nodeIntegralSubstep.clear();
+  levelOffsets.clear();
+  levelPores.clear();
+
+  poreHDConcentration.clear();
+  poreInflowShare.clear();
+  poreIsolated.clear();
+  feedingOffsets.clear();
+  feedingPores.clear();
+  feedingInflows.clear();
+
+  nodeIndex.clear();
+  nodeFlow.clear();
+  nodeMassFlow.clear();
+  nodeConcentration.clear();
+  nodeHDConcentration.clear();
+  nodeOrder.clear();
+  nodePores.clear();
+}
+
+int networkArrays::getPoresNumber() const { return poreIndex.size(); }
+
+int networkArrays::getNodesNumber() const { return nodeIndex.size(); }
+
+int networkArrays::getUpstreamNode(int pore) const {
+  return poreFlow[pore] > 0 ? poreNodeOut[pore] : poreNodeIn[pore];
+}
+
+int networkArrays::getDownstreamNode(int pore) const {
+  return poreFlow[pore] > 0 ? poreNodeIn[pore] : poreNodeOut[pore];
+}
+
+bool networkArrays::sortNodesAlongFlow() {
+  int nodesNumber = getNodesNumber();
+  vector<int> feedingPores(nodesNumber, 0);
+  for (int i = 0; i < getPoresNumber(); ++i) {
+    if (poreInlet[i] || abs(poreFlow[i]) < 1e-20 || getUpstreamNode(i) == -1)
+      continue;
+    int downstream = getDownstreamNode(i);
+    if (downstream != -1) feedingPores[downstream]++;
+  }
+
+  nodeOrder.clear();
+  nodeOrder.reserve(nodesNumber);
+  for (int i = 0; i < nodesNumber; ++i)
+    if (feedingPores[i] == 0) nodeOrder.push_back(i);
+
+  for (unsigned l = 0; l < nodeOrder.size(); ++l) {
+    int n = nodeOrder[l];
+    for (int j = nodePores.offsets[n]; j < nodePores.offsets[n + 1]; ++j) {
+      int q = nodePores.pores[j];
+      if (poreInlet[q] || abs(poreFlow[q]) < 1e-20 || getUpstreamNode(q) != n)
+        continue;
+      int downstream = getDownstreamNode(q);
+      if (downstream != -1 && --feedingPores[downstream] == 0)
+        nodeOrder.push_back(downstream);
+    }
+  }
+
+  if (int(nodeOrder.size()) == nodesNumber) return true;
+
+  for (int i = 0; i < nodesNumber; ++i)
+    if (feedingPores[i] > 0) nodeOrder.push_back(i);
+  return false;
+}
+
+int networkArrays::assignTimeStepLevels(double step, int levels) {
+  int poresNumber = getPoresNumber();
+  int nodesNumber = getNodesNumber();
+  poreLevel.assign(poresNumber, 0);
+  poreInflowNode.resize(poresNumber);
+  poreInflowStart.assign(poresNumber, 0);
+  poreNextConcentration.assign(poresNumber, 0);
+  nodeMixedConcentration.assign(nodesNumber + 2, 0);
+  nodeInflowIntegral.assign(nodesNumber + 2, 0);
+  nodeIntegralSubstep.assign(nodesNumber + 2, 0);
+
+  int highestLevel(0);
+  for (int i = 0; i < poresNumber; ++i) {
+    // stagnant pores keep their concentration and are not stepped at all
+    double flow = abs(poreFlow[i]);
+    if (flow >= 1e-20) {
+      int level = 0;
+      while (level < levels - 1 &&
+             ldexp(step, level + 1) * flow <= poreVolume[i])
+        ++level;
+      poreLevel[i] = level;
+      highestLevel = max(highestLevel, level);
+    }
+
+    int upstream = getUpstreamNode(i);
+    if (poreInlet[i])
+      poreInflowNode[i] = nodesNumber;
+    else if (upstream == -1)
+      poreInflowNode[i] = nodesNumber + 1;
+    else
+      poreInflowNode[i] = upstream;
+  }
+
+  levelOffsets.assign(highestLevel + 2, 0);
+  for (int i = 0; i < poresNumber; ++i)
+    if (abs(poreFlow[i]) >= 1e-20) levelOffsets[poreLevel[i] + 1]++;
+  for (int l = 0; l <= highestLevel; ++l)
+    levelOffsets[l + 1] += levelOffsets[l];
+  levelPores.resize(levelOffsets.back());
+  vector<int> position(levelOffsets.begin(), levelOffsets.end() - 1);
+  for (int i = 0; i < poresNumber; ++i)
+    if (abs(poreFlow[i]) >= 1e-20) levelPores[position[poreLevel[i]]++] = i;
+
+  return highestLevel;
+}
+
+int networkArrays::getLevelsNumber() const { return levelOffsets.size() - 1; }
+
+void network::gatherNetworkArrays() {
+  networkArrays& a = *vesselArrays;
+  a.clear();
+
+  vector<int> compactNode(totalNodes, -1);
+  for (int i = 0; i < totalNodes; ++i) {
+    node* n = getNode(i);
+    if (n->getClosed()) continue;
+    compactNode[i] = a.nodeIndex.size();
+    a.nodeIndex.push_back(i);
+  }
+  int nodesNumber = a.nodeIndex.size();
+  a.nodeFlow.assign(nodesNumber, 0);
+  a.nodeMassFlow.assign(nodesNumber, 0);
+  a.nodeConcentration.resize(nodesNumber);
+  for (int i = 0; i < nodesNumber; ++i)
+    a.nodeConcentration[i] = getNode(a.nodeIndex[i])->getConcentration();
+
+  vector<int> compactPore(totalPores, -1);
+  for (int i = 0; i < totalPores; ++i) {
+    pore* p = getPore(i);
+    if (p->getClosed()) continue;
+    compactPore[i] = a.poreIndex.size();
+    a.poreIndex.push_back(i);
+    node* nodeIn = p->getNodeIn();
+    node* nodeOut = p->getNodeOut();
+    a.poreNodeIn.push_back(nodeIn == 0 ? -1 : compactNode[nodeIn->getId() - 1]);
+    a.poreNodeOut.push_back(nodeOut == 0 ? -1
+                                         : compactNode[nodeOut->getId() - 1]);
+    a.poreInlet.push_back(p->getInlet());
+    a.poreOutlet.push_back(p->getOutlet());
+    a.poreVesselType.push_back(p->getVesselType());
+    a.poreFlow.push_back(p->getFlow());
+    a.poreVolume.push_back(p->getVolume());
+    a.poreConcentration.push_back(p->getConcentration());
+  }
+
+  updateNetworkGraph();
+  const networkGraph& graph = *nodePores;
+  networkGraph& compactGraph = a.nodePores;
+  for (int i = 0; i < nodesNumber; ++i) {
+    int n = a.nodeIndex[i];
+    for (int j = graph.offsets[n]; j < graph.offsets[n + 1]; ++j)
+      if (compactPore[graph.pores[j]] != -1) {
+        compactGraph.pores.push_back(compactPore[graph.pores[j]]);
+        compactGraph.signs.push_back(graph.signs[j]);
+      }
+    compactGraph.offsets.push_back(compactGraph.pores.size());
+  }
+}
+
+void network::scatterConcentrations() {
+  const networkArrays& a = *vesselArrays;
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < a.getPoresNumber(); ++i)
+    getPore(a.poreIndex[i])->setConcentration(a.poreConcentration[i]);
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < a.getNodesNumber(); ++i)
+    getNode(a.nodeIndex[i])->setConcentration(a.nodeConcentration[i]);
+}
+
+void network::gatherHaematocritArrays() {
+  setFeedingVessels();
+  gatherNetworkArrays();
+  networkArrays& a = *vesselArrays;
+
+  vector<int> compactPore(totalPores, -1);
+  for (int i = 0; i < a.getPoresNumber(); ++i) compactPore[a.poreIndex[i]] = i;
+
+  a.feedingOffsets.push_back(0);
+  for (int i = 0; i < a.getPoresNumber(); ++i) {
+    pore* p = getPore(a.poreIndex[i]);
+    a.poreHDConcentration.push_back(p->getHDConcentration());
+    a.poreInflowShare.push_back(phaseSeparation ? p->getFQE()
+                                                : p->getInflowShare());
+    a.poreIsolated.push_back(p->getConductivity() == 1e-200);
+    if (!p->getInlet())
+      for (auto iterator : p->getFeedingVessels()) {
+        int q = compactPore[iterator.first - 1];
+        if (q == -1) continue;
+        a.feedingPores.push_back(q);
+        a.feedingInflows.push_back(iterator.second);
+      }
+    a.feedingOffsets.push_back(a.feedingPores.size());
+  }
+
+  a.nodeHDConcentration.resize(a.getNodesNumber());
+  for (int i = 0; i < a.getNodesNumber(); ++i)
+    a.nodeHDConcentration[i] = getNode(a.nodeIndex[i])->getHDConcentration();
+}
+
+void network::scatterHaematocrit() {
+  const networkArrays& a = *vesselArrays;
+  for (int i = 0; i < a.getPoresNumber(); ++i)
+    getPore(a.poreIndex[i])->setHDConcentration(a.poreHDConcentration[i]);
+  for (int i = 0; i < a.getNodesNumber(); ++i)
+    getNode(a.nodeIndex[i])->setHDConcentration(a.nodeHDConcentration[i]);
+}
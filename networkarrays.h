@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef NETWORKARRAYS_H
+#define NETWORKARRAYS_H
+
+#include "networkgraph.h"
+
+#include <vector>
+
+// Structure-of-arrays copy of the opened pores and nodes for the time-stepping
+// loops, which only touch a few attributes of each element. Pores and nodes
+// are numbered compactly in id order and poreNodeIn/poreNodeOut hold compact
+// node numbers, -1 when the pore ends at the boundary or on a closed node, and
+// nodePores is the node-pore adjacency restricted to the opened elements.
+// The pore and node objects remain the reference state: the network fills the
+// arrays once the flow field is known and writes the concentrations back. The
+// drug flow without diffusion and the haematocrit flow of the angiogenesis
+// model run on these arrays.
+struct networkArrays {
+  void clear();
+
+  int getPoresNumber() const;
+  int getNodesNumber() const;
+
+  // compact node feeding/fed by a pore, -1 at the boundary
+  int getUpstreamNode(int pore) const;
+  int getDownstreamNode(int pore) const;
+
+  // fills nodeOrder with the nodes sorted along the flow, each node after all
+  // the nodes upstream of it, stagnant pores (|flow| < 1e-20) linking none;
+  // returns false when the flow field has loops, the nodes on the loops are
+  // then appended in index order
+  bool sortNodesAlongFlow();
+
+  // sorts the flowing pores into levels 0 to levels - 1, level l pores being
+  // advanced with step * 2^l, the largest such step within their transit
+  // time; stagnant pores are left out of levelPores. Returns the highest
+  // level used
+  int assignTimeStepLevels(double step, int levels);
+  int getLevelsNumber() const;
+
+  // pores
+  std::vector<int> poreIndex;
+  std::vector<int> poreNodeIn;
+  std::vector<int> poreNodeOut;
+  std::vector<char> poreInlet;
+  std::vector<char> poreOutlet;
+  std::vector<int> poreVesselType;
+  std::vector<double> poreFlow;
+  std::vector<double> poreVolume;
+  std::vector<double> poreConcentration;
+  std::vector<double> poreNextConcentration;
+
+  // multirate stepping: the inflow node of a pore is its upstream node, the
+  // inlet (nodesNumber) or no inflow (nodesNumber + 1), and levelPores lists
+  // the flowing pores by increasing level, level l from levelOffsets[l]
+  std::vector<int> poreLevel;
+  std::vector<int> poreInflowNode;
+  std::vector<double> poreInflowStart;
+  std::vector<double> nodeMixedConcentration;
+  std::vector<double> nodeInflowIntegral;
+  std::vector<int> nodeIntegralSubstep;
+  std::vector<int> levelOffsets;
+  std::vector<int> levelPores;
+
+  // haematocrit flow: feedingPores lists the pores flowing into pore i from
+  // feedingOffsets[i], with the flow they bring to its upstream node, and
+  // poreInflowShare is the inflow share (or the FQE with phase separation)
+  std::vector<double> poreHDConcentration;
+  std::vector<double> poreInflowShare;
+  std::vector<char> poreIsolated;
+  std::vector<int> feedingOffsets;
+  std::vector<int> feedingPores;
+  std::vector<double> feedingInflows;
+
+  // nodes
+  std::vector<int> nodeIndex;
+  std::vector<double> nodeFlow;
+  std::vector<double> nodeMassFlow;
+  std::vector<double> nodeConcentration;
+  std::vector<double> nodeHDConcentration;
+  std::vector<int> nodeOrder;
+  networkGraph nodePores;
+};
+
+#endif  // NETWORKARRAYS_H
@@ -0,0 +1,43 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "networkgraph.h"
+#include "network.h"
+
+using namespace std;
+
+networkGraph::networkGraph() { clear(); }
+
+void networkGraph::clear() {
+  offsets.assign(1, 0);
+  pores.clear();
+  signs.clear();
+}
+
+int networkGraph::getNodesNumber() const { return offsets.size() - 1; }
+
+void network::buildNetworkGraph() {
+  networkGraph& g = *nodePores;
+  g.clear();
+  g.offsets.reserve(totalNodes + 1);
+  for (int i = 0; i < totalNodes; ++i) {
+    node* n = getNode(i);
+    const vector<int>& connectedPores = n->getConnectedPores();
+    for (unsigned j = 0; j < connectedPores.size(); ++j) {
+      g.pores.push_back(connectedPores[j] - 1);
+      g.signs.push_back(getPore(connectedPores[j] - 1)->getNodeIn() == n ? 1
+                                                                         : -1);
+    }
+    g.offsets.push_back(g.pores.size());
+  }
+  networkGraphOutdated = false;
+}
+
+void network::updateNetworkGraph() {
+  if (networkGraphOutdated || nodePores->getNodesNumber() != totalNodes)
+    buildNetworkGraph();
+}
@@ -0,0 +1,32 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef NETWORKGRAPH_H
+#define NETWORKGRAPH_H
+
+#include <vector>
+
+// Compressed sparse row adjacency between nodes and pores. The pores connected
+// to the node at position i of the node table are pores[offsets[i]] to
+// pores[offsets[i + 1] - 1], given as positions in the pore table, in the
+// order of node::getConnectedPores. signs[k] is +1 when the node is the nodeIn
+// of the pore and -1 when it is its nodeOut, so that signs[k] * flow is
+// positive when the pore flows into the node. The graph is rebuilt from the
+// node tables whenever the topology changes (networkGraphOutdated).
+struct networkGraph {
+  networkGraph();
+
+  void clear();
+
+  int getNodesNumber() const;
+
+  std::vector<int> offsets;
+  std::vector<int> pores;
+  std::vector<signed char> signs;
+};
+
+#endif  // NETWORKGRAPH_H
@@ -33,6 +33,12 @@ win32 {
 
 unix {
     LIBS += -lGLEW
+    QMAKE_CXXFLAGS += -fopenmp
+    QMAKE_LFLAGS += -fopenmp
+}
+
+win32-msvc* {
+    QMAKE_CXXFLAGS += /openmp
 }
 
 
@@ -52,14 +58,24 @@ SOURCES += main.cpp \
     generationRegular.cpp \
     misc.cpp \
     block.cpp \
-    particle.cpp \
+    particlepool.cpp \
     artificial.cpp \
     drugflow.cpp \
+    drugensemble.cpp \
     particleflow.cpp \
     angiogenesis.cpp \
     angioFlow.cpp \
     parentvessel.cpp \
     retina.cpp \
+    pressuresolver.cpp \
+    multigridsolver.cpp \
+    networkarrays.cpp \
+    networkgraph.cpp \
+    aliastable.cpp \
+    tissuecoupling.cpp \
+    diffusionstencil.cpp \
+    trajectorywriter.cpp \
+    snapshotwriter.cpp \
     libs/qcustomplot/qcustomplot.cpp
 
 HEADERS += \
@@ -73,7 +89,19 @@ HEADERS += \
     worker.h \
     element.h \
     block.h \
-    particle.h \
+    particlepool.h \
+    pressuresolver.h \
+    multigridsolver.h \
+    networkarrays.h \
+    networkgraph.h \
+    aliastable.h \
+    counterrandom.h \
+    tissuecoupling.h \
+    diffusionstencil.h \
+    trajectorywriter.h \
+    snapshotwriter.h \
+    latticegrid.h \
+    elementarena.h \
     libs/qcustomplot/qcustomplot.h
 
 INCLUDEPATH += libs
@@ -26,21 +26,12 @@ void network::createParentVessel() {
 
   cout << "Creating Nodes..." << endl;
 
-  tableOfNodes.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfNodes[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfNodes[i][j].resize(Nz);
-  }
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz; ++k) {
-        tableOfNodes[i][j][k] = 0;
-      }
+  tableOfNodes.resize(Nx, Ny, Nz, 0);
 
   for (int i = 0; i < Ny; i++) {
-    node* n = new node(0, i, 0);
+    node* n = new (nodeArena) node(0, i, 0);
     tableOfAllNodes.push_back(n);
-    tableOfNodes[0][i][0] = n;
+    tableOfNodes(0, i, 0) = n;
     n->setId(i + 1);
     n->setXCoordinate(n->getIndexX() * length);
     n->setYCoordinate(n->getIndexY() * length);
@@ -48,45 +39,21 @@ void network::createParentVessel() {
   }
 
   cout << "Creating Pores..." << endl;
-  tableOfPoresX.resize(Nx + 1);
-  for (int i = 0; i < Nx + 1; ++i) {
-    tableOfPoresX[i].resize(Ny + 1);
-    for (int j = 0; j < Ny; ++j) tableOfPoresX[i][j].resize(Nz);
-  }
-
-  tableOfPoresY.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresY[i].resize(Ny + 1);
-    for (int j = 0; j < Ny + 1; ++j) tableOfPoresY[i][j].resize(Nz);
-  }
-
-  tableOfPoresZ.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresZ[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfPoresZ[i][j].resize(Nz + 1);
-  }
+  tableOfPoresX.resize(Nx + 1, Ny, Nz, 0);
+  tableOfPoresY.resize(Nx, Ny + 1, Nz, 0);
+  tableOfPoresZ.resize(Nx, Ny, Nz + 1, 0);
 
-  for (int i = 0; i < Nx + 1; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz; ++k) tableOfPoresX[i][j][k] = 0;
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny + 1; ++j)
-      for (int k = 0; k < Nz; ++k) tableOfPoresY[i][j][k] = 0;
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz + 1; ++k) tableOfPoresZ[i][j][k] = 0;
-
-  pore* inletPore = new pore(getNode(0), 0);
+  pore* inletPore = new (poreArena) pore(getNode(0), 0);
   tableOfAllPores.push_back(inletPore);
-  tableOfPoresX[0][0][0] = inletPore;
-  pore* outletPore = new pore(0, getNode(Ny - 1));
+  tableOfPoresX(0, 0, 0) = inletPore;
+  pore* outletPore = new (poreArena) pore(0, getNode(Ny - 1));
   tableOfAllPores.push_back(outletPore);
-  tableOfPoresX[0][Ny - 1][0] = outletPore;
+  tableOfPoresX(0, Ny - 1, 0) = outletPore;
 
   for (int i = 0; i < Ny - 1; i++) {
-    pore* p = new pore(getNode(i + 1), getNode(i));
+    pore* p = new (poreArena) pore(getNode(i + 1), getNode(i));
     tableOfAllPores.push_back(p);
-    tableOfPoresY[0][i + 1][0] = p;
+    tableOfPoresY(0, i + 1, 0) = p;
   }
 
   for (int i = 0; i < totalPores; ++i) {
@@ -138,21 +105,12 @@ void network::createParentVessel3D() {
 
   cout << "Creating Nodes..." << endl;
 
-  tableOfNodes.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfNodes[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfNodes[i][j].resize(Nz);
-  }
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz; ++k) {
-        tableOfNodes[i][j][k] = 0;
-      }
+  tableOfNodes.resize(Nx, Ny, Nz, 0);
 
   for (int i = 0; i < Ny; i++) {
-    node* n = new node(0, i, Nz / 3);
+    node* n = new (nodeArena) node(0, i, Nz / 3);
     tableOfAllNodes.push_back(n);
-    tableOfNodes[0][i][Nz / 3] = n;
+    tableOfNodes(0, i, Nz / 3) = n;
     n->setId(i + 1);
     n->setXCoordinate(n->getIndexX() * length);
     n->setYCoordinate(n->getIndexY() * length);
@@ -160,9 +118,9 @@ void network::createParentVessel3D() {
   }
 
   for (int i = 0; i < Ny; i++) {
-    node* n = new node(0, i, 2 * Nz / 3);
+    node* n = new (nodeArena) node(0, i, 2 * Nz / 3);
     tableOfAllNodes.push_back(n);
-    tableOfNodes[0][i][2 * Nz / 3] = n;
+    tableOfNodes(0, i, 2 * Nz / 3) = n;
     n->setId(i + 1 + Ny);
     n->setXCoordinate(n->getIndexX() * length);
     n->setYCoordinate(n->getIndexY() * length);
@@ -170,66 +128,42 @@ void network::createParentVessel3D() {
   }
 
   cout << "Creating Pores..." << endl;
-  tableOfPoresX.resize(Nx + 1);
-  for (int i = 0; i < Nx + 1; ++i) {
-    tableOfPoresX[i].resize(Ny + 1);
-    for (int j = 0; j < Ny; ++j) tableOfPoresX[i][j].resize(Nz);
-  }
-
-  tableOfPoresY.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresY[i].resize(Ny + 1);
-    for (int j = 0; j < Ny + 1; ++j) tableOfPoresY[i][j].resize(Nz);
-  }
-
-  tableOfPoresZ.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresZ[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfPoresZ[i][j].resize(Nz + 1);
-  }
+  tableOfPoresX.resize(Nx + 1, Ny, Nz, 0);
+  tableOfPoresY.resize(Nx, Ny + 1, Nz, 0);
+  tableOfPoresZ.resize(Nx, Ny, Nz + 1, 0);
 
-  for (int i = 0; i < Nx + 1; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz; ++k) tableOfPoresX[i][j][k] = 0;
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny + 1; ++j)
-      for (int k = 0; k < Nz; ++k) tableOfPoresY[i][j][k] = 0;
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz + 1; ++k) tableOfPoresZ[i][j][k] = 0;
-
-  pore* inletPore = new pore(getNode(0), 0);
+  pore* inletPore = new (poreArena) pore(getNode(0), 0);
   tableOfAllPores.push_back(inletPore);
-  tableOfPoresX[0][0][Nz / 3] = inletPore;
-  pore* outletPore = new pore(0, getNode(Ny - 1));
+  tableOfPoresX(0, 0, Nz / 3) = inletPore;
+  pore* outletPore = new (poreArena) pore(0, getNode(Ny - 1));
   tableOfAllPores.push_back(outletPore);
-  tableOfPoresX[0][Ny - 1][Nz / 3] = outletPore;
+  tableOfPoresX(0, Ny - 1, Nz / 3) = outletPore;
 
-  inletPore = new pore(getNode(0 + Ny), 0);
+  inletPore = new (poreArena) pore(getNode(0 + Ny), 0);
   tableOfAllPores.push_back(inletPore);
-  tableOfPoresX[0][0][2 * Nz / 3] = inletPore;
-  outletPore = new pore(0, getNode(Ny - 1 + Ny));
+  tableOfPoresX(0, 0, 2 * Nz / 3) = inletPore;
+  outletPore = new (poreArena) pore(0, getNode(Ny - 1 + Ny));
   tableOfAllPores.push_back(outletPore);
-  tableOfPoresX[0][Ny - 1][2 * Nz / 3] = outletPore;
+  tableOfPoresX(0, Ny - 1, 2 * Nz / 3) = outletPore;
 
-  pore* xPore = new pore(getNode(0), getNode(Ny));
+  pore* xPore = new (poreArena) pore(getNode(0), getNode(Ny));
   xPore->setVesselType(1);
   tableOfAllPores.push_back(xPore);
 
-  pore* xPore2 = new pore(getNode(Ny - 1), getNode(Ny - 1 + Ny));
+  pore* xPore2 = new (poreArena) pore(getNode(Ny - 1), getNode(Ny - 1 + Ny));
   tableOfAllPores.push_back(xPore2);
   xPore2->setVesselType(1);
 
   for (int i = 0; i < Ny - 1; i++) {
-    pore* p = new pore(getNode(i + 1), getNode(i));
+    pore* p = new (poreArena) pore(getNode(i + 1), getNode(i));
     tableOfAllPores.push_back(p);
-    tableOfPoresY[0][i + 1][Nz / 3] = p;
+    tableOfPoresY(0, i + 1, Nz / 3) = p;
   }
 
   for (int i = 0; i < Ny - 1; i++) {
-    pore* p = new pore(getNode(i + 1 + Ny), getNode(i + Ny));
+    pore* p = new (poreArena) pore(getNode(i + 1 + Ny), getNode(i + Ny));
     tableOfAllPores.push_back(p);
-    tableOfPoresY[0][i + 1][2 * Nz / 3] = p;
+    tableOfPoresY(0, i + 1, 2 * Nz / 3) = p;
   }
 
   for (int i = 0; i < totalPores; ++i) {
@@ -289,58 +223,24 @@ void network::createRetinaParentVessels() {
 
   // Initialising tables
 
-  tableOfNodes.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfNodes[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfNodes[i][j].resize(Nz);
-  }
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz; ++k) {
-        tableOfNodes[i][j][k] = 0;
-      }
-
-  tableOfPoresX.resize(Nx + 1);
-  for (int i = 0; i < Nx + 1; ++i) {
-    tableOfPoresX[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfPoresX[i][j].resize(Nz);
-  }
-
-  tableOfPoresY.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresY[i].resize(Ny + 1);
-    for (int j = 0; j < Ny + 1; ++j) tableOfPoresY[i][j].resize(Nz);
-  }
-
-  tableOfPoresZ.resize(Nx);
-  for (int i = 0; i < Nx; ++i) {
-    tableOfPoresZ[i].resize(Ny);
-    for (int j = 0; j < Ny; ++j) tableOfPoresZ[i][j].resize(Nz + 1);
-  }
+  tableOfNodes.resize(Nx, Ny, Nz, 0);
 
-  for (int i = 0; i < Nx + 1; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz; ++k) tableOfPoresX[i][j][k] = 0;
-
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny + 1; ++j)
-      for (int k = 0; k < Nz; ++k) tableOfPoresY[i][j][k] = 0;
-  for (int i = 0; i < Nx; ++i)
-    for (int j = 0; j < Ny; ++j)
-      for (int k = 0; k < Nz + 1; ++k) tableOfPoresZ[i][j][k] = 0;
+  tableOfPoresX.resize(Nx + 1, Ny, Nz, 0);
+  tableOfPoresY.resize(Nx, Ny + 1, Nz, 0);
+  tableOfPoresZ.resize(Nx, Ny, Nz + 1, 0);
 
   // Creating elements
 
   cout << "Creating Central nodes..." << endl;
   int cx(Nx / 2), cy(Ny / 2);
-  node* ncenter1 = new node(cx, cy, 0);
+  node* ncenter1 = new (nodeArena) node(cx, cy, 0);
   tableOfAllNodes.push_back(ncenter1);
   ncenter1->setId(1);
   ncenter1->setXCoordinate(ncenter1->getIndexX() * length);
   ncenter1->setYCoordinate(ncenter1->getIndexY() * length);
   ncenter1->setZCoordinate(ncenter1->getIndexZ() * length);
 
-  node* ncenter2 = new node(cx, cy, 0);
+  node* ncenter2 = new (nodeArena) node(cx, cy, 0);
   tableOfAllNodes.push_back(ncenter2);
   ncenter2->setId(2);
   ncenter2->setXCoordinate(ncenter2->getIndexX() * length);
@@ -349,7 +249,7 @@ void network::createRetinaParentVessels() {
 
   cout << "Creating inlet/outlet vessels..." << endl;
   // inlet nad outlet pore
-  pore* inletPore = new pore(ncenter1, 0);
+  pore* inletPore = new (poreArena) pore(ncenter1, 0);
   tableOfAllPores.push_back(inletPore);
   inletPore->setId(1);
   inletPore->setRadius(14e-6);
@@ -359,7 +259,7 @@ void network::createRetinaParentVessels() {
   inletPore->setFullLength(length);
   inletPore->setInlet(true);
 
-  pore* outletPore = new pore(0, ncenter2);
+  pore* outletPore = new (poreArena) pore(0, ncenter2);
   tableOfAllPores.push_back(outletPore);
   outletPore->setId(2);
   outletPore->setRadius(14e-6);
@@ -379,9 +279,9 @@ void network::createRetinaParentVessels() {
     double iy = int(nodalRadius * sin(theta));
 
     // create a node at the bounday of the circle
-    node* n = new node(Nx / 2 + ix, Ny / 2 + iy, 0);
+    node* n = new (nodeArena) node(Nx / 2 + ix, Ny / 2 + iy, 0);
     tableOfAllNodes.push_back(n);
-    tableOfNodes[Nx / 2 + ix][Ny / 2 + iy][0] = n;
+    tableOfNodes(Nx / 2 + ix, Ny / 2 + iy, 0) = n;
     n->setId(++currentNodeIndex);
     n->setXCoordinate(n->getIndexX() * length);
     n->setYCoordinate(n->getIndexY() * length);
@@ -389,7 +289,7 @@ void network::createRetinaParentVessels() {
 
     // create the associated pore
     node* ncenter = i % 2 ? ncenter1 : ncenter2;
-    pore* p = new pore(n, ncenter);
+    pore* p = new (poreArena) pore(n, ncenter);
     tableOfAllPores.push_back(p);
     p->setId(++currentPoreIndex);
     p->setRadius(10e-6);
@@ -397,18 +297,11 @@ void network::createRetinaParentVessels() {
     p->setHDConcentration(1);
   }
 
-  // Update the ranking for the solver
-  int rank = 0;
-  for (int i = 0; i < totalNodes; ++i) {
-    node* n = getNode(i);
-    if (!n->getClosed()) {
-      n->setRank(rank);
-      rank++;
-    }
-  }
-
   cout << "Setting Neighboors..." << endl;
   setNeighboorsForEntireNetwork();
+
+  // Update the ranking for the solver
+  updateRanking();
   cout << "Assigning Lengths..." << endl;
   assignLengths();
   distortNetwork();
@@ -6,20 +6,32 @@
 /////////////////////////////////////////////////////////////////////////////
 
 #include "network.h"
+#include "aliastable.h"
+#include "counterrandom.h"
+#include "particlepool.h"
 #include "tools.h"
+#include "trajectorywriter.h"
 
 #include <thread>
+#include <unordered_map>
 
 using namespace std;
 
 void network::runParticleFlow() {
   initialiseSimulation();
 
+  // particle positions are streamed to a binary file during the run and
+  // converted to text at the end, the text of a previous run is cleared first
   ofstream file("Results/particleData.txt");
+  file.close();
+  bool trajectoriesOpened = trajectories->open("Results/particleData.bin");
+  if (!trajectoriesOpened)
+    cout << "Cannot open Results/particleData.bin: particle positions are "
+            "not saved"
+         << endl;
   ofstream file1("Results/vesselData.txt");
   ofstream file2("Results/nodalData.txt");
   ofstream file3("Results/exploredVolume.txt");
-  file << "";
 
   cout << "Starting Flow in Artificial Network... " << endl;
 
@@ -29,7 +41,6 @@ void network::runParticleFlow() {
   double simulationTimeElapsed(0);
   int outputCount(0);
   double timeSoFar = 0;
-  double timeToInject = 0;
   double originalStep = 100000;
   double timeToDoubleFlow = 100000;
 
@@ -38,29 +49,7 @@ void network::runParticleFlow() {
   assignConductivities();
 
   // set constant flow rate
-  double Q1(0), Q2(0), A, B;
-
-  pressureIn = 1;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q1 = getOutletFlow();
-
-  pressureIn = 2;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
-  Q2 = getOutletFlow();
-
-  B = (Q1 - Q2 * 1 / 2) / (1 - 1 / 2);
-  A = (Q1 - B);
-
-  deltaP = flowRate / A - B / A;
-
-  pressureIn = deltaP;
-  pressureOut = 0;
-  solvePressures();
-  updateFlows();
+  solveForFlowRate(flowRate);
 
   // Mass conservation check
 
@@ -89,23 +78,10 @@ void network::runParticleFlow() {
     }
   }
 
-  for (int i = 0; i < totalNodes; ++i) {
-    node* n = getNode(i);
-    if (!n->getClosed()) {
-      vector<int> connectedPores = n->getConnectedPores();
-      double sumFlowIn = 0;
-      for (unsigned j = 0; j < connectedPores.size(); ++j) {
-        pore* p = getPore(connectedPores[j] - 1);
-        if (!p->getClosed()) {
-          if ((p->getNodeIn() == n && p->getFlow() > 0) ||
-              (p->getNodeOut() == n && p->getFlow() < 0)) {
-            sumFlowIn += abs(p->getFlow());
-          }
-        }
-      }
-      n->setFlow(sumFlowIn);
-    }
-  }
+  // junction and injection choices are drawn from alias tables of the flows
+  updateFlowRoutes();
+  const aliasTable& outflows = *outflowRoutes;
+  const aliasTable& inlets = *inletRoutes;
 
   file1 << "vesselID node1ID node2ID Radius Length Flow" << endl;
   file2 << "nodeID x y z" << endl;
@@ -127,181 +103,206 @@ void network::runParticleFlow() {
           << endl;
   }
 
-  vector<pore*> inletPores;
-  double globalTimeStep = 1e50;
-  for (int i = 0; i < totalPores; ++i) {
-    pore* p = getPore(i);
-    if (!p->getClosed() && p->getInlet()) inletPores.push_back(p);
-    if (!p->getClosed() && p->getVolume() / abs(p->getFlow()) < globalTimeStep)
-      globalTimeStep = p->getVolume() / abs(p->getFlow());
-  }
-
-  for (int i = 0; i < totalParticles; ++i) delete tableOfParticles[i];
-
+  particlePool& pool = *particles;
+  pool.clear();
   totalParticles = 0;
-  tableOfParticles.clear();
-  double totalCurrentParticles = 0;
   double totalVisitedVolume(0);
 
+  // Particles do not interact, so each one is advanced on its own from one
+  // arrival at the end of its pore to the next, in parallel, and draws its
+  // choices from its own random stream: particle id and number of draws. The
+  // results do not depend on the number of threads. Between arrivals a
+  // particle moves at the constant speed of its pore, so positions are only
+  // computed when a frame is output.
+  counterRandom random(seed);
+
+  // first visit time of each pore, for the explored volume
+  vector<double> visitTime(totalPores, 1e50);
+  for (int i = 0; i < totalPores; ++i)
+    if (getPore(i)->getVisited()) visitTime[i] = 0;
+
+  auto enterPore = [&](int i, pore* pp, double time) {
+    pool.poreIDs[i] = pp->getId();
+    pool.entryTimes[i] = time;
+    pool.entryPositions[i] = pp->getFlow() > 0 ? 0 : 1;
+    pool.speeds[i] = 0;
+    pool.arrivalTimes[i] = 1e50;
+    if (abs(pp->getFlow()) > 1e-20) {
+      pool.speeds[i] = pp->getFlow() / pp->getVolume();
+      pool.arrivalTimes[i] = time + pp->getVolume() / abs(pp->getFlow());
+    }
+  };
+
+  auto placeParticle = [&](int i, double time) {
+    pore* pp = getPore(pool.poreIDs[i] - 1);
+    double position =
+        pool.entryPositions[i] + (time - pool.entryTimes[i]) * pool.speeds[i];
+    position = min(1., max(0., position));
+    pool.porePositions[i] = position;
+
+    double xOut = pp->getNodeOut() == 0
+                      ? pp->getNodeIn()->getXCoordinate() - pp->getLength()
+                      : pp->getNodeOut()->getXCoordinate();
+    double xIn = pp->getNodeIn() == 0
+                     ? pp->getNodeOut()->getXCoordinate() + pp->getLength()
+                     : pp->getNodeIn()->getXCoordinate();
+    double yOut = pp->getNodeOut() == 0 ? pp->getNodeIn()->getYCoordinate()
+                                        : pp->getNodeOut()->getYCoordinate();
+    double yIn = pp->getNodeIn() == 0 ? pp->getNodeOut()->getYCoordinate()
+                                      : pp->getNodeIn()->getYCoordinate();
+    double zOut = pp->getNodeOut() == 0 ? pp->getNodeIn()->getZCoordinate()
+                                        : pp->getNodeOut()->getZCoordinate();
+    double zIn = pp->getNodeIn() == 0 ? pp->getNodeOut()->getZCoordinate()
+                                      : pp->getNodeIn()->getZCoordinate();
+    pool.xCoordinates[i] = xOut + position * (xIn - xOut);
+    pool.yCoordinates[i] = yOut + position * (yIn - yOut);
+    pool.zCoordinates[i] = zOut + position * (zIn - zOut);
+  };
+
+  // frames are output every extraction time step; the loop advances by at
+  // most a thousandth of the simulation time to keep the plots and the
+  // cancellation responsive
+  double outputStep =
+      extractionTimestep > 0 ? extractionTimestep : simulationTime;
+  double frameStep = min(outputStep, simulationTime / 1000);
+  double nextOutput = outputStep;
+  double nextInjection = injectionInterval;
+  bool injection = injectParticles && inlets.items.size() > 0;
+
   // post-processing
   if (videoRecording) record = true;
 
   while (timeSoFar < simulationTime) {
-    // set time step
-
-    timeStep = 1e50;
-    for (int i = 0; i < totalParticles; ++i) {
-      particle* p = getParticle(i);
-      if (!p->getClosed()) {
-        pore* pp = getPore(p->getPoreID() - 1);
-        if (abs(pp->getFlow()) > 1e-20) {
-          double fraction = pp->getFlow() > 0 ? p->getPorePosition()
-                                              : 1 - p->getPorePosition();
-          double step = (1 - fraction) * pp->getVolume() / abs(pp->getFlow());
-          if (step < timeStep) timeStep = step;
-        }
+    double frameTime =
+        min(min(timeSoFar + frameStep, nextOutput), simulationTime);
+
+    vector<double> injectionTimes;
+    while (injection && nextInjection <= frameTime) {
+      totalParticles++;
+      int i = pool.add(totalParticles);
+      double dice = random.uniform(totalParticles, pool.draws[i]++);
+      enterPore(i, getPore(inlets.choose(0, dice)), nextInjection);
+      injectionTimes.push_back(nextInjection);
+
+      // the injection rate doubles every originalStep
+      while (nextInjection > timeToDoubleFlow) {
+        injectionInterval /= 2.;
+        timeToDoubleFlow += originalStep;
       }
+      nextInjection += injectionInterval;
     }
 
-    timeStep = timeStep == 1e50 ? globalTimeStep : timeStep;
-
-    if (timeStep > 1e20) cancel = true;
-
-    // update particle positions
-
-    for (int i = 0; i < totalParticles; ++i) {
-      particle* p = getParticle(i);
-      if (!p->getClosed()) {
-        pore* pp = getPore(p->getPoreID() - 1);
-        if (abs(pp->getFlow()) > 1e-20) {
-          double newPosition =
-              p->getPorePosition() + timeStep * pp->getFlow() / pp->getVolume();
-
-          double xOut =
-              pp->getNodeOut() == 0
-                  ? pp->getNodeIn()->getXCoordinate() - pp->getLength()
-                  : pp->getNodeOut()->getXCoordinate();
-          double xIn =
-              pp->getNodeIn() == 0
-                  ? pp->getNodeOut()->getXCoordinate() + pp->getLength()
-                  : pp->getNodeIn()->getXCoordinate();
-          double yOut = pp->getNodeOut() == 0
-                            ? pp->getNodeIn()->getYCoordinate()
-                            : pp->getNodeOut()->getYCoordinate();
-          double yIn = pp->getNodeIn() == 0 ? pp->getNodeOut()->getYCoordinate()
-                                            : pp->getNodeIn()->getYCoordinate();
-          double zOut = pp->getNodeOut() == 0
-                            ? pp->getNodeIn()->getZCoordinate()
-                            : pp->getNodeOut()->getZCoordinate();
-          double zIn = pp->getNodeIn() == 0 ? pp->getNodeOut()->getZCoordinate()
-                                            : pp->getNodeIn()->getZCoordinate();
-          p->setXCoordinate(xOut + newPosition * (xIn - xOut));
-          p->setYCoordinate(yOut + newPosition * (yIn - yOut));
-          p->setZCoordinate(zOut + newPosition * (zIn - zOut));
-
-          if (abs(newPosition) > 1e-10 && abs(newPosition) < 1 - 1e-10)
-            p->setPorePosition(newPosition);
+    // pores explored during the frame, each thread keeping the first time it
+    // reached a pore
+    vector<pair<double, int>> explored;
+    vector<int> exited;
+    int activeNumber = pool.getActiveNumber();
+
+#pragma omp parallel
+    {
+      unordered_map<int, double> threadVisits;
+      vector<int> threadExited;
+
+#pragma omp for schedule(dynamic, 64)
+      for (int a = 0; a < activeNumber; ++a) {
+        int i = pool.active[a];
+        while (pool.arrivalTimes[i] <= frameTime) {
+          double time = pool.arrivalTimes[i];
+          pore* pp = getPore(pool.poreIDs[i] - 1);
+          if (visitTime[pp->getId() - 1] == 1e50) {
+            auto visit = threadVisits.insert(make_pair(pp->getId() - 1, time));
+            if (!visit.second)
+              visit.first->second = min(visit.first->second, time);
+          }
 
+          // leave the network or pick a pore leaving the node, with a
+          // probability proportional to its flow
+          if (pp->getOutlet()) {
+            threadExited.push_back(i);
+            break;
+          }
+
+          node* n = pp->getFlow() > 0 ? pp->getNodeIn() : pp->getNodeOut();
+          double dice = random.uniform(pool.ids[i], pool.draws[i]++);
+          int next = outflows.choose(n->getId() - 1, dice);
+          if (next != -1)
+            enterPore(i, getPore(next), time);
           else {
-            if (!pp->getVisited()) totalVisitedVolume += pp->getVolume();
-            pp->setVisited(true);
-            // assign to a new pore // or close
-            if (pp->getOutlet()) {
-              p->setClosed(true);
-              totalCurrentParticles--;
-            } else {
-              double dice = uniform_real();
-              double cumulutativeProbability = 0;
-              node* n = pp->getFlow() > 0 ? pp->getNodeIn() : pp->getNodeOut();
-              vector<int> connectedPores = n->getConnectedPores();
-              for (unsigned j = 0; j < connectedPores.size(); ++j) {
-                pore* np = getPore(connectedPores[j] - 1);
-                if (!np->getClosed()) {
-                  if ((np->getNodeIn() == n && np->getFlow() < 0) ||
-                      (np->getNodeOut() == n && np->getFlow() > 0)) {
-                    cumulutativeProbability +=
-                        abs(np->getFlow()) / n->getFlow();
-                    if (dice < cumulutativeProbability) {
-                      p->setPoreID(np->getId());
-                      p->setPorePosition(np->getFlow() > 0 ? 0 : 1);
-                      break;
-                    }
-                  }
-                }
-              }
-            }
+            // dead end: the particle stays at the node
+            pool.entryTimes[i] = time;
+            pool.entryPositions[i] = pp->getFlow() > 0 ? 1 : 0;
+            pool.speeds[i] = 0;
+            pool.arrivalTimes[i] = 1e50;
           }
         }
-
-        if (p->getPorePosition() == 1 &&
-                getPore(p->getPoreID() - 1)->getFlow() > 0 ||
-            p->getPorePosition() == 0 &&
-                getPore(p->getPoreID() - 1)->getFlow() < 0)
-          cout << "ff" << endl;
       }
-    }
-
-    if (timeStep != 1e50) timeSoFar += timeStep;
 
-    timeToInject += timeStep;
-
-    if (injectParticles && timeToInject > injectionInterval) {
-      totalParticles++;
-      totalCurrentParticles++;
-      particle* p = new particle();
-      pore* pp;
-
-      double dice = uniform_real();
-      double cumulutativeProbability = 0;
-      for (unsigned i = 0; i < inletPores.size(); ++i) {
-        pore* inPore = inletPores[i];
-        cumulutativeProbability += abs(inPore->getFlow()) / flowRate;
-        if (dice < cumulutativeProbability) {
-          pp = inPore;
-          break;
+#pragma omp critical
+      {
+        for (auto& visit : threadVisits) {
+          if (visitTime[visit.first] == 1e50)
+            explored.push_back(make_pair(0., visit.first));
+          visitTime[visit.first] = min(visitTime[visit.first], visit.second);
         }
+        exited.insert(exited.end(), threadExited.begin(), threadExited.end());
       }
+    }
 
-      p->setPoreID(pp->getId());
-      p->setPorePosition(0);
-      p->setXCoordinate(pp->getNodeOut() == 0
-                            ? pp->getNodeIn()->getXCoordinate() -
-                                  pp->getLength()
-                            : pp->getNodeOut()->getXCoordinate());
-      p->setYCoordinate(pp->getNodeOut() == 0
-                            ? pp->getNodeIn()->getYCoordinate()
-                            : pp->getNodeOut()->getYCoordinate());
-      p->setZCoordinate(pp->getNodeOut() == 0
-                            ? pp->getNodeIn()->getZCoordinate()
-                            : pp->getNodeOut()->getZCoordinate());
-      p->setId(totalParticles);
-      tableOfParticles.push_back(p);
-      timeToInject = 0;
-
-      file3 << totalParticles << " " << totalVisitedVolume / totalPoresVolume
+    // the slots are freed in a fixed order to keep the runs reproducible
+    sort(exited.begin(), exited.end());
+    for (unsigned k = 0; k < exited.size(); ++k) pool.remove(exited[k]);
+
+    // explored pores in the order of their first visit
+    for (unsigned k = 0; k < explored.size(); ++k)
+      explored[k].first = visitTime[explored[k].second];
+    sort(explored.begin(), explored.end());
+
+    unsigned k = 0;
+    int injected = totalParticles - injectionTimes.size();
+    for (unsigned j = 0; j < injectionTimes.size(); ++j) {
+      for (; k < explored.size() && explored[k].first <= injectionTimes[j]; ++k)
+        totalVisitedVolume += getPore(explored[k].second)->getVolume();
+      file3 << injected + j + 1 << " " << totalVisitedVolume / totalPoresVolume
             << endl;
     }
+    for (; k < explored.size(); ++k)
+      totalVisitedVolume += getPore(explored[k].second)->getVolume();
+    for (unsigned j = 0; j < explored.size(); ++j)
+      getPore(explored[j].second)->setVisited(true);
+
+    timeSoFar = frameTime;
+
+    activeNumber = pool.getActiveNumber();
+#pragma omp parallel for schedule(static)
+    for (int a = 0; a < activeNumber; ++a)
+      placeParticle(pool.active[a], timeSoFar);
 
     emitPlotSignal();
 
-    if (extractData && totalCurrentParticles >= 1) {
-      endTime = tools::getCPUTime();
-      extractParticleFlowResults(endTime - startTime, timeSoFar,
-                                 simulationTimeElapsed, outputCount, true);
+    if (timeSoFar >= nextOutput) {
+      nextOutput += outputStep;
+      if (extractData && pool.getActiveNumber() >= 1) {
+        endTime = tools::getCPUTime();
+        extractParticleFlowResults(endTime - startTime, timeSoFar,
+                                   simulationTimeElapsed, outputCount, true);
+      }
     }
 
-    if (record && totalCurrentParticles >= 1)
+    if (record && pool.getActiveNumber() >= 1)
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
 
-    if (timeSoFar > timeToDoubleFlow) {
-      injectionInterval /= 2.;
-      timeToDoubleFlow += originalStep;
-    }
-
     // Thread Management
     if (cancel) break;
   }
 
+  if (trajectoriesOpened) {
+    if (!trajectories->close())
+      cout << "Error writing Results/particleData.bin" << endl;
+    else if (!trajectoryWriter::convertToText("Results/particleData.bin",
+                                              "Results/particleData.txt"))
+      cout << "Error converting Results/particleData.bin to text" << endl;
+  }
+
   // post-processing
   if (videoRecording) {
     record = false;
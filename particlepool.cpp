@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "particlepool.h"
+
+using namespace std;
+
+particlePool::particlePool() { clear(); }
+
+void particlePool::clear() {
+  active.clear();
+  ids.clear();
+  poreIDs.clear();
+  porePositions.clear();
+  xCoordinates.clear();
+  yCoordinates.clear();
+  zCoordinates.clear();
+  entryTimes.clear();
+  entryPositions.clear();
+  speeds.clear();
+  arrivalTimes.clear();
+  draws.clear();
+  freeSlots.clear();
+  activePositions.clear();
+}
+
+int particlePool::add(int id) {
+  int slot;
+  if (!freeSlots.empty()) {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    slot = ids.size();
+    ids.push_back(0);
+    poreIDs.push_back(0);
+    porePositions.push_back(0);
+    xCoordinates.push_back(0);
+    yCoordinates.push_back(0);
+    zCoordinates.push_back(0);
+    entryTimes.push_back(0);
+    entryPositions.push_back(0);
+    speeds.push_back(0);
+    arrivalTimes.push_back(0);
+    draws.push_back(0);
+    activePositions.push_back(-1);
+  }
+
+  ids[slot] = id;
+  draws[slot] = 0;
+  activePositions[slot] = active.size();
+  active.push_back(slot);
+  return slot;
+}
+
+void particlePool::remove(int slot) {
+  int position = activePositions[slot];
+  int last = active.back();
+  active[position] = last;
+  activePositions[last] = position;
+  active.pop_back();
+  activePositions[slot] = -1;
+  freeSlots.push_back(slot);
+}
+
+int particlePool::getActiveNumber() const { return active.size(); }
@@ -0,0 +1,49 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PARTICLEPOOL_H
+#define PARTICLEPOOL_H
+
+#include <vector>
+
+// Particles of the particle flow, stored as arrays indexed by slot. The slot
+// of a particle leaving the network is given to the next injected one, and
+// active lists the occupied slots densely, so loops over the particles only
+// visit those still in the network. remove() moves the last active slot into
+// the place of the removed one.
+struct particlePool {
+  particlePool();
+
+  void clear();
+  int add(int id);
+  void remove(int slot);
+
+  int getActiveNumber() const;
+
+  std::vector<int> active;
+
+  // by slot
+  std::vector<int> ids;
+  std::vector<int> poreIDs;
+  std::vector<double> porePositions;
+  std::vector<double> xCoordinates;
+  std::vector<double> yCoordinates;
+  std::vector<double> zCoordinates;
+
+  // motion in the current pore and number of random draws made
+  std::vector<double> entryTimes;
+  std::vector<double> entryPositions;
+  std::vector<double> speeds;
+  std::vector<double> arrivalTimes;
+  std::vector<unsigned> draws;
+
+ private:
+  std::vector<int> freeSlots;
+  std::vector<int> activePositions;
+};
+
+#endif  // PARTICLEPOOL_H
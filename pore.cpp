@@ -21,12 +21,6 @@ pore::pore(node *const &pNodeIn, node *const &pNodeOut) {
 
 pore::~pore() {}
 
-std::vector<pore *> &pore::getNeighboors() { return neighboors; }
-
-void pore::setNeighboors(const std::vector<pore *> &value) {
-  neighboors = value;
-}
-
 double pore::getNodeInLength() const { return nodeInLength; }
 
 void pore::setNodeInLength(double value) { nodeInLength = value; }
@@ -71,9 +71,6 @@ class pore : public element {
   double getConductedStim() const;
   void setConductedStim(double value);
 
-  std::vector<pore *> &getNeighboors();
-  void setNeighboors(const std::vector<pore *> &value);
-
   std::map<int, double> &neighbooringBlocksArea();
   void setTissueNeighboorsArea(const std::map<int, double> &value);
 
@@ -87,8 +84,6 @@ class pore : public element {
   double nodeInLength;
   double nodeOutLength;
 
-  std::vector<pore *> neighboors;
-
   // Drug flow attributes
   std::map<int, double> feedingVessels;
   std::map<int, double> neighbooringBlocksAreaMap;
@@ -0,0 +1,302 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "pressuresolver.h"
+#include "tools.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace std;
+using namespace Eigen;
+
+namespace {
+bool haveSamePattern(const SparseMatrix<double> &a,
+                     const SparseMatrix<double> &b) {
+  return a.rows() == b.rows() && a.cols() == b.cols() &&
+         a.nonZeros() == b.nonZeros() &&
+         equal(a.outerIndexPtr(), a.outerIndexPtr() + a.outerSize() + 1,
+               b.outerIndexPtr()) &&
+         equal(a.innerIndexPtr(), a.innerIndexPtr() + a.nonZeros(),
+               b.innerIndexPtr());
+}
+}  // namespace
+
+pressureSolver::pressureSolver() {
+  solverChoice = 1;
+  analyses = 0;
+  factorizations = 0;
+  solves = 0;
+  updates = 0;
+  factorNonZeros = 0;
+  maxUpdateRank = 100;
+  maxConsecutiveUpdates = 20;
+  iterations = 0;
+  totalIterations = 0;
+  error = 0;
+  reset();
+}
+
+void pressureSolver::reset() {
+  size = 0;
+  analyzed = false;
+  factorized = false;
+  triplets.clear();
+  conductivityMatrix = SparseMatrix<double>();
+  positiveMatrix = SparseMatrix<double>();
+  factoredMatrix = SparseMatrix<double>();
+  appendedDiagonal.resize(0);
+  updateIndices.clear();
+  consecutiveUpdates = 0;
+}
+
+int pressureSolver::getSolverChoice() const { return solverChoice; }
+
+void pressureSolver::setSolverChoice(int value) {
+  if (value == solverChoice) return;
+  solverChoice = value;
+  analyzed = false;
+  factorized = false;
+}
+
+void pressureSolver::beginAssembly(int value) {
+  size = value;
+  triplets.resize(tools::maxThreads());
+  for (unsigned i = 0; i < triplets.size(); ++i) triplets[i].clear();
+}
+
+void pressureSolver::addCoefficient(int row, int col, double value) {
+  triplets[tools::threadNumber()].push_back(Triplet<double>(row, col, value));
+}
+
+void pressureSolver::endAssembly() {
+  // each row is assembled by a single thread, so the merged list keeps the
+  // order of the coefficients within a row and the summation is reproducible
+  vector<Triplet<double> > &allTriplets = triplets[0];
+  for (unsigned i = 1; i < triplets.size(); ++i) {
+    allTriplets.insert(allTriplets.end(), triplets[i].begin(),
+                       triplets[i].end());
+    triplets[i].clear();
+  }
+
+  SparseMatrix<double> assembledMatrix(size, size);
+  assembledMatrix.setFromTriplets(allTriplets.begin(), allTriplets.end());
+  assembledMatrix.makeCompressed();
+
+  bool sameValues =
+      haveSamePattern(conductivityMatrix, assembledMatrix) &&
+      equal(conductivityMatrix.valuePtr(),
+            conductivityMatrix.valuePtr() + conductivityMatrix.nonZeros(),
+            assembledMatrix.valuePtr());
+
+  if (sameValues) return;
+
+  conductivityMatrix.swap(assembledMatrix);
+
+  if (solverChoice == 1 && factorized && updateFactorization()) return;
+
+  if (!haveSamePattern(factoredMatrix, conductivityMatrix)) analyzed = false;
+  factorized = false;
+}
+
+VectorXd pressureSolver::solve(const VectorXd &b, const VectorXd &guess) {
+  if (!factorized) factorize();
+
+  iterations = 0;
+  error = 0;
+
+  VectorXd pressures = VectorXd::Zero(size);
+  if (solverChoice == 1) {
+    if (factoredMatrix.rows() == size && updateIndices.empty())
+      pressures = ldlt.solve(b);
+    else {
+      // one step of iterative refinement recovers the accuracy lost in the
+      // low-rank correction
+      pressures = solveUpdated(b);
+      pressures += solveUpdated(b - conductivityMatrix * pressures);
+    }
+  }
+  if (solverChoice == 2) {
+    pressures = bicgstab.solve(b);
+    iterations = bicgstab.iterations();
+    error = bicgstab.error();
+  }
+  if (solverChoice == 3) {
+    // the conductivity matrix is negative definite: solve -A.x = -b
+    if (guess.size() == size)
+      pressures = pcg.solveWithGuess(-b, guess);
+    else
+      pressures = pcg.solve(-b);
+    iterations = pcg.iterations();
+    error = pcg.error();
+  }
+  totalIterations += iterations;
+
+  solves++;
+  return pressures;
+}
+
+void pressureSolver::factorize() {
+  if (solverChoice == 1) {
+    if (!analyzed) {
+      ldlt.analyzePattern(conductivityMatrix);
+      analyses++;
+    }
+    ldlt.factorize(conductivityMatrix);
+    factorNonZeros = ldlt.matrixL().nestedExpression().nonZeros();
+  }
+  if (solverChoice == 2) {
+    bicgstab.setTolerance(1e-6);
+    bicgstab.setMaxIterations(1000);
+    bicgstab.compute(conductivityMatrix);
+    factorNonZeros = 0;
+  }
+  if (solverChoice == 3) {
+    positiveMatrix = -conductivityMatrix;
+    pcg.setTolerance(1e-10);
+    if (!analyzed) {
+      pcg.analyzePattern(positiveMatrix);
+      analyses++;
+    }
+    pcg.factorize(positiveMatrix);
+    factorNonZeros = pcg.preconditioner().matrixL().nonZeros();
+  }
+  factoredMatrix = conductivityMatrix;
+  appendedDiagonal.resize(0);
+  updateIndices.clear();
+  updateSolves.resize(0, 0);
+  updateBlock.resize(0, 0);
+  consecutiveUpdates = 0;
+
+  analyzed = true;
+  factorized = true;
+  factorizations++;
+}
+
+bool pressureSolver::updateFactorization() {
+  int factoredSize = factoredMatrix.rows();
+  if (size < factoredSize) return false;
+  if (consecutiveUpdates >= maxConsecutiveUpdates) return false;
+
+  // rows appended since the factorization enter the base matrix through
+  // their diagonal only
+  int appended = appendedDiagonal.size();
+  if (factoredSize + appended > size) return false;
+  appendedDiagonal.conservativeResize(size - factoredSize);
+  for (int i = factoredSize + appended; i < size; ++i) {
+    double diagonal = conductivityMatrix.coeff(i, i);
+    if (diagonal == 0) return false;
+    appendedDiagonal[i - factoredSize] = diagonal;
+  }
+
+  vector<Triplet<double> > baseTriplets;
+  baseTriplets.reserve(factoredMatrix.nonZeros() + appendedDiagonal.size());
+  for (int k = 0; k < factoredMatrix.outerSize(); ++k)
+    for (SparseMatrix<double>::InnerIterator it(factoredMatrix, k); it; ++it)
+      baseTriplets.push_back(Triplet<double>(it.row(), it.col(), it.value()));
+  for (int i = 0; i < appendedDiagonal.size(); ++i)
+    baseTriplets.push_back(Triplet<double>(factoredSize + i, factoredSize + i,
+                                           appendedDiagonal[i]));
+  SparseMatrix<double> baseMatrix(size, size);
+  baseMatrix.setFromTriplets(baseTriplets.begin(), baseTriplets.end());
+
+  SparseMatrix<double> difference = conductivityMatrix - baseMatrix;
+  difference.prune(
+      [](const Index &, const Index &, const double &value) {
+        return value != 0;
+      });
+
+  vector<int> indices;
+  for (int k = 0; k < difference.outerSize(); ++k)
+    if (SparseMatrix<double>::InnerIterator(difference, k))
+      indices.push_back(k);
+
+  int rank = indices.size();
+  if (rank > maxUpdateRank || rank > size / 10) return false;
+
+  // reuse the base solves of rows that were already touched
+  map<int, int> previousColumns;
+  for (unsigned i = 0; i < updateIndices.size(); ++i)
+    previousColumns[updateIndices[i]] = i;
+
+  MatrixXd solves(size, rank);
+  for (int j = 0; j < rank; ++j) {
+    map<int, int>::iterator it = previousColumns.find(indices[j]);
+    if (it != previousColumns.end()) {
+      int previousSize = updateSolves.rows();
+      solves.col(j).head(previousSize) = updateSolves.col(it->second);
+      solves.col(j).tail(size - previousSize).setZero();
+    } else {
+      VectorXd unit = VectorXd::Zero(size);
+      unit[indices[j]] = 1;
+      solves.col(j) = solveFactored(unit);
+    }
+  }
+
+  MatrixXd block(rank, rank);
+  MatrixXd projectedSolves(rank, rank);
+  for (int i = 0; i < rank; ++i)
+    for (int j = 0; j < rank; ++j) {
+      block(i, j) = difference.coeff(indices[i], indices[j]);
+      projectedSolves(i, j) = solves(indices[i], j);
+    }
+
+  PartialPivLU<MatrixXd> lu(MatrixXd::Identity(rank, rank) +
+                            block * projectedSolves);
+  if (rank > 0 && !(lu.rcond() > 1e-12)) return false;
+
+  updateIndices.swap(indices);
+  updateSolves.swap(solves);
+  updateBlock.swap(block);
+  capacitance = lu;
+
+  consecutiveUpdates++;
+  updates++;
+  return true;
+}
+
+VectorXd pressureSolver::solveFactored(const VectorXd &b) const {
+  int factoredSize = factoredMatrix.rows();
+  VectorXd x(b.size());
+  x.head(factoredSize) = ldlt.solve(b.head(factoredSize));
+  x.tail(b.size() - factoredSize) =
+      b.tail(b.size() - factoredSize).cwiseQuotient(appendedDiagonal);
+  return x;
+}
+
+VectorXd pressureSolver::solveUpdated(const VectorXd &b) const {
+  VectorXd x = solveFactored(b);
+  int rank = updateIndices.size();
+  if (rank == 0) return x;
+
+  VectorXd projected(rank);
+  for (int i = 0; i < rank; ++i) projected[i] = x[updateIndices[i]];
+  x -= updateSolves * capacitance.solve(updateBlock * projected);
+  return x;
+}
+
+int pressureSolver::getSize() const { return size; }
+
+int pressureSolver::getAnalyses() const { return analyses; }
+
+int pressureSolver::getFactorizations() const { return factorizations; }
+
+int pressureSolver::getSolves() const { return solves; }
+
+int pressureSolver::getUpdates() const { return updates; }
+
+int pressureSolver::getFactorNonZeros() const { return factorNonZeros; }
+
+int pressureSolver::getMaxUpdateRank() const { return maxUpdateRank; }
+
+void pressureSolver::setMaxUpdateRank(int value) { maxUpdateRank = value; }
+
+int pressureSolver::getIterations() const { return iterations; }
+
+double pressureSolver::getError() const { return error; }
+
+int pressureSolver::getTotalIterations() const { return totalIterations; }
@@ -0,0 +1,114 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef PRESSURESOLVER_H
+#define PRESSURESOLVER_H
+
+#include <vector>
+
+// Eigen library
+#include <Eigen/Dense>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+// Keeps the conductivity matrix of the network together with its symbolic
+// analysis and numeric factorization between pressure solves. The matrix is
+// reassembled on every call and compared with the cached one: the pattern is
+// only re-analysed when the topology changes and the factorization is only
+// recomputed when the conductivities change.
+//
+// Solver choices: 1 = SimplicialLDLT, 2 = BiCGSTAB, 3 = conjugate gradient with
+// an incomplete Cholesky preconditioner, warm-started from an initial guess.
+//
+// When only a few rows change (vessels added, resized or closed, nodes
+// appended) the LDLT factorization is kept and the change is applied as a
+// low-rank correction: appended nodes extend the factored matrix with their
+// diagonal and the remaining difference D, restricted to the touched rows T,
+// is solved through the Woodbury identity
+//   (B + E.D.E^T)^-1 = B^-1 - B^-1.E.(I + D.E^T.B^-1.E)^-1.D.E^T.B^-1
+// The matrix is refactorized when T grows too large or after a number of
+// consecutive updates.
+class pressureSolver {
+ public:
+  pressureSolver();
+
+  void reset();
+
+  int getSolverChoice() const;
+  void setSolverChoice(int value);
+
+  // addCoefficient can be called concurrently from OpenMP threads as long as
+  // each row is assembled by a single thread
+  void beginAssembly(int value);
+  void addCoefficient(int row, int col, double value);
+  void endAssembly();
+
+  Eigen::VectorXd solve(const Eigen::VectorXd &b,
+                        const Eigen::VectorXd &guess = Eigen::VectorXd());
+
+  int getSize() const;
+  int getAnalyses() const;
+  int getFactorizations() const;
+  int getSolves() const;
+  int getUpdates() const;
+  int getFactorNonZeros() const;
+
+  int getMaxUpdateRank() const;
+  void setMaxUpdateRank(int value);
+
+  // iterative solvers: statistics of the last solve
+  int getIterations() const;
+  double getError() const;
+  int getTotalIterations() const;
+
+ private:
+  void factorize();
+  bool updateFactorization();
+  Eigen::VectorXd solveFactored(const Eigen::VectorXd &b) const;
+  Eigen::VectorXd solveUpdated(const Eigen::VectorXd &b) const;
+
+  int solverChoice;
+  int size;
+
+  bool analyzed;
+  bool factorized;
+
+  int analyses;
+  int factorizations;
+  int solves;
+  int updates;
+  int factorNonZeros;
+  int consecutiveUpdates;
+  int maxUpdateRank;
+  int maxConsecutiveUpdates;
+  int iterations;
+  int totalIterations;
+  double error;
+
+  // one coefficient list per thread
+  std::vector<std::vector<Eigen::Triplet<double> > > triplets;
+  Eigen::SparseMatrix<double> conductivityMatrix;
+  Eigen::SparseMatrix<double> positiveMatrix;
+
+  // low-rank update of the LDLT factorization
+  Eigen::SparseMatrix<double> factoredMatrix;
+  Eigen::VectorXd appendedDiagonal;
+  std::vector<int> updateIndices;
+  Eigen::MatrixXd updateSolves;
+  Eigen::MatrixXd updateBlock;
+  Eigen::PartialPivLU<Eigen::MatrixXd> capacitance;
+
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldlt;
+  Eigen::BiCGSTAB<Eigen::SparseMatrix<double> > bicgstab;
+  Eigen::ConjugateGradient<Eigen::SparseMatrix<double>,
+                           Eigen::Lower | Eigen::Upper,
+                           Eigen::IncompleteCholesky<double> >
+      pcg;
+};
+
+#endif  // PRESSURESOLVER_H
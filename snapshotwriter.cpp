@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "snapshotwriter.h"
+
+#include <boost/lexical_cast.hpp>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+snapshotWriter::snapshotWriter() : filling(-1), closing(false) {
+  freeBuffers.push_back(0);
+  freeBuffers.push_back(1);
+}
+
+snapshotWriter::~snapshotWriter() { finish(); }
+
+snapshotWriter::snapshot &snapshotWriter::acquire() {
+  unique_lock<std::mutex> lock(mutex);
+  if (!writer.joinable()) {
+    closing = false;
+    writer = thread(&snapshotWriter::run, this);
+  }
+  changed.wait(lock, [this] { return !freeBuffers.empty(); });
+  filling = freeBuffers.front();
+  freeBuffers.pop_front();
+  return buffers[filling];
+}
+
+void snapshotWriter::submit() {
+  {
+    lock_guard<std::mutex> lock(mutex);
+    pendingBuffers.push_back(filling);
+    filling = -1;
+  }
+  changed.notify_all();
+}
+
+void snapshotWriter::finish() {
+  if (!writer.joinable()) return;
+  {
+    lock_guard<std::mutex> lock(mutex);
+    closing = true;
+  }
+  changed.notify_all();
+  writer.join();
+}
+
+void snapshotWriter::run() {
+  unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    changed.wait(lock, [this] { return closing || !pendingBuffers.empty(); });
+    if (pendingBuffers.empty()) break;
+
+    // the buffer stays out of both lists while it is written
+    int b = pendingBuffers.front();
+    pendingBuffers.pop_front();
+    lock.unlock();
+    write(buffers[b]);
+    lock.lock();
+
+    freeBuffers.push_back(b);
+    changed.notify_all();
+  }
+}
+
+void snapshotWriter::write(const snapshot &s) const {
+  string suffix = boost::lexical_cast<string>(1000000000 + s.outputCount);
+
+  ofstream ofs1("Results/output.txt", ofstream::app);
+  ofs1 << s.outputCount << " " << s.time << "\n";
+
+  ofstream file1(
+      ("Results/Network_Status/conc_pores" + suffix + ".txt").c_str());
+  for (unsigned i = 0; i < s.poreIDs.size(); ++i)
+    file1 << s.poreIDs[i] << " " << s.poreConcentrations[i] << "\n";
+
+  if (s.withNodes) {
+    ofstream file2(
+        ("Results/Network_Status/conc_nodes" + suffix + ".txt").c_str());
+    for (unsigned i = 0; i < s.nodeIDs.size(); ++i)
+      file2 << s.nodeIDs[i] << " " << s.nodeConcentrations[i] << "\n";
+  }
+
+  ofstream file3(
+      ("Results/Network_Status/conc_blocks" + suffix + ".txt").c_str());
+  for (unsigned i = 0; i < s.blockIDs.size(); ++i)
+    file3 << s.blockIDs[i] << " " << s.blockConcentrations[i] << "\n";
+}
@@ -0,0 +1,58 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Concentration snapshots of Results/Network_Status written by a dedicated
+// thread. The simulation copies the concentrations into one of two staging
+// buffers, acquire() then submit(), and goes on while the thread writes the
+// other one; acquire() waits when both buffers are still pending. finish()
+// returns once every submitted snapshot is on disk.
+class snapshotWriter {
+ public:
+  struct snapshot {
+    int outputCount;
+    double time;
+    bool withNodes;
+    std::vector<int> poreIDs;
+    std::vector<double> poreConcentrations;
+    std::vector<int> nodeIDs;
+    std::vector<double> nodeConcentrations;
+    std::vector<int> blockIDs;
+    std::vector<double> blockConcentrations;
+  };
+
+  snapshotWriter();
+  ~snapshotWriter();
+
+  snapshot &acquire();
+  void submit();
+  void finish();
+
+ private:
+  void run();
+  void write(const snapshot &s) const;
+
+  snapshot buffers[2];
+  std::deque<int> freeBuffers;
+  std::deque<int> pendingBuffers;
+  int filling;
+
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool closing;
+};
+
+#endif  // SNAPSHOTWRITER_H
@@ -5,21 +5,19 @@
 /// Licence:     Attribution-NonCommercial 4.0 International
 /////////////////////////////////////////////////////////////////////////////
 
+#include "multigridsolver.h"
 #include "network.h"
-
-// Eigen library
-#include <Eigen/IterativeLinearSolvers>
-#include <Eigen/Sparse>
-#include <Eigen/SparseCholesky>
+#include "networkgraph.h"
+#include "pressuresolver.h"
+#include "tissuecoupling.h"
 
 using namespace std;
 using namespace Eigen;
 
 void network::solvePressuresForRegularModel() {
-  SparseMatrix<double> conductivityMatrix(Nx * Ny * Nz, Nx * Ny * Nz);
-  conductivityMatrix.reserve(VectorXi::Constant(Nx * Ny * Nz, 7));
+  pressureSystem->setSolverChoice(solverChoice == 4 ? 3 : solverChoice);
+  pressureSystem->beginAssembly(Nx * Ny * Nz);
   VectorXd b = VectorXd::Zero(Nx * Ny * Nz);
-  VectorXd pressures = VectorXd::Zero(Nx * Ny * Nz);
 
   int row = 0;
   for (int k = 0; k < Nz; ++k)
@@ -45,34 +43,23 @@ void network::solvePressuresForRegularModel() {
         if (i == 0) b(row) = -pressureIn * cW;
         if (i == Nx - 1) b(row) = -pressureOut * cE;
 
-        conductivityMatrix.insert(row, n->getRank()) = c;
-        if (i != 0) conductivityMatrix.insert(row, nW->getRank()) = cW;
-        if (i != Nx - 1) conductivityMatrix.insert(row, nE->getRank()) = cE;
+        pressureSystem->addCoefficient(row, n->getRank(), c);
+        if (i != 0) pressureSystem->addCoefficient(row, nW->getRank(), cW);
+        if (i != Nx - 1) pressureSystem->addCoefficient(row, nE->getRank(), cE);
         if (j != 0)
-          if (Ny != 2) conductivityMatrix.insert(row, nS->getRank()) = cS;
-        if (j != Ny - 1) conductivityMatrix.insert(row, nN->getRank()) = cN;
+          if (Ny != 2) pressureSystem->addCoefficient(row, nS->getRank(), cS);
+        if (j != Ny - 1) pressureSystem->addCoefficient(row, nN->getRank(), cN);
         if (k != 0)
           if (Nz != 1)
-            if (Nz != 2) conductivityMatrix.insert(row, nD->getRank()) = cD;
+            if (Nz != 2)
+              pressureSystem->addCoefficient(row, nD->getRank(), cD);
         if (k != Nz - 1)
-          if (Nz != 1) conductivityMatrix.insert(row, nU->getRank()) = cU;
+          if (Nz != 1) pressureSystem->addCoefficient(row, nU->getRank(), cU);
         row++;
       }
-  conductivityMatrix.makeCompressed();
+  pressureSystem->endAssembly();
 
-  if (solverChoice == 1) {
-    SimplicialLDLT<SparseMatrix<double> > solver;
-    solver.compute(conductivityMatrix);
-    pressures = solver.solve(b);
-  }
-  if (solverChoice == 2) {
-    BiCGSTAB<SparseMatrix<double> > solver;
-    solver.setTolerance(1e-6);
-    solver.setMaxIterations(1000);
-    solver.compute(conductivityMatrix);
-    pressures = solver.solve(b);
-    // cout<<solver.error()<<" "<<solver.iterations()<<endl;
-  }
+  VectorXd pressures = pressureSystem->solve(b);
 
   for (int i = 0; i < Nx; ++i)
     for (int j = 0; j < Ny; ++j)
@@ -81,21 +68,29 @@ void network::solvePressuresForRegularModel() {
 }
 
 void network::solvePressures() {
-  SparseMatrix<double> conductivityMatrix(totalOpenedNodes, totalOpenedNodes);
-  conductivityMatrix.reserve(
-      VectorXi::Constant(totalOpenedNodes, maxConnectionNumber + 3));
+  // the multigrid solver needs the lattice structure of regular networks,
+  // other networks fall back to the preconditioned conjugate gradient
+  if (solverChoice == 4 && networkSource == 1) {
+    solvePressuresWithMultigrid();
+    return;
+  }
+
+  pressureSystem->setSolverChoice(solverChoice == 4 ? 3 : solverChoice);
+  pressureSystem->beginAssembly(totalOpenedNodes);
   VectorXd b = VectorXd::Zero(totalOpenedNodes);
-  VectorXd pressures = VectorXd::Zero(totalOpenedNodes);
 
-  int row = 0;
+  updateNetworkGraph();
+  const networkGraph& graph = *nodePores;
+
+  // rows are independent: each thread fills the rows of its own nodes
+#pragma omp parallel for schedule(static)
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (!n->getClosed()) {
-      vector<int> neighboors = n->getNeighboors();
-      vector<int> connectedPores = n->getConnectedPores();
+      int row = n->getRank();
       double conductivity(0);
-      for (unsigned j = 0; j < neighboors.size(); ++j) {
-        pore* p = getPore(connectedPores[j] - 1);
+      for (int j = graph.offsets[i]; j < graph.offsets[i + 1]; ++j) {
+        pore* p = getPore(graph.pores[j]);
         if (!p->getClosed()) {
           if (p->getInlet()) {
             b(row) += -pressureIn * p->getConductivity();
@@ -106,42 +101,221 @@ void network::solvePressures() {
             conductivity -= p->getConductivity();
           }
           if (!p->getInlet() && !p->getOutlet()) {
-            node* neighboor = getNode(neighboors[j] - 1);
+            node* neighboor =
+                graph.signs[j] > 0 ? p->getNodeOut() : p->getNodeIn();
             if (!neighboor->getClosed()) {
-              conductivityMatrix.insert(row, neighboor->getRank()) =
-                  p->getConductivity();
+              pressureSystem->addCoefficient(row, neighboor->getRank(),
+                                             p->getConductivity());
               conductivity -= p->getConductivity();
             }
           }
         }
       }
-      conductivityMatrix.insert(row, n->getRank()) = conductivity;
-      row++;
+      pressureSystem->addCoefficient(row, row, conductivity);
     }
   }
-  conductivityMatrix.makeCompressed();
+  pressureSystem->endAssembly();
 
-  if (solverChoice == 1) {
-    SimplicialLDLT<SparseMatrix<double> > solver;
-    solver.compute(conductivityMatrix);
-    pressures = solver.solve(b);
-  }
-  if (solverChoice == 2) {
-    BiCGSTAB<SparseMatrix<double> > solver;
-    solver.setTolerance(1e-6);
-    solver.setMaxIterations(1000);
-    solver.compute(conductivityMatrix);
-    pressures = solver.solve(b);
-    // cout<<solver.error()<<" "<<solver.iterations()<<endl;
+  // warm start iterative solvers from the current pressure field, rescaled to
+  // the new inlet pressure (the field is linear in pressureIn)
+  VectorXd guess;
+  if (solverChoice >= 3) {
+    double scale = 1;
+    if (solvedPressureIn != 0 && pressureOut == 0)
+      scale = pressureIn / solvedPressureIn;
+    guess = VectorXd::Zero(totalOpenedNodes);
+    for (int i = 0; i < totalNodes; ++i) {
+      node* n = getNode(i);
+      if (!n->getClosed()) guess[n->getRank()] = n->getPressure() * scale;
+    }
   }
 
+  VectorXd pressures = pressureSystem->solve(b, guess);
+
+#pragma omp parallel for schedule(static)
   for (int i = 0; i < totalNodes; ++i) {
     node* n = getNode(i);
     if (!n->getClosed()) n->setPressure(pressures[n->getRank()]);
   }
+  solvedPressureIn = pressureIn;
+}
+
+void network::solvePressuresWithMultigrid() {
+  int size = Nx * Ny * Nz;
+  vector<double> cx(size, 0), cy(size, 0), cz(size, 0), sink(size, 0);
+  vector<double> b(size, 0), pressures(size, 0);
+  vector<char> live(size, 0);
+
+  double scale = 1;
+  if (solvedPressureIn != 0 && pressureOut == 0)
+    scale = pressureIn / solvedPressureIn;
+
+  for (int k = 0; k < Nz; ++k)
+    for (int j = 0; j < Ny; ++j)
+      for (int i = 0; i < Nx; ++i) {
+        int idx = i + Nx * (j + Ny * k);
+        node *n = getNode(i, j, k);
+        if (n->getClosed()) continue;
+        live[idx] = 1;
+        pressures[idx] = n->getPressure() * scale;
+
+        // only the +x/+y/+z pores are stored as lattice faces
+        pore *connectedPores[6] = {getPoreX(i, j, k), getPoreXout(i, j, k),
+                                   getPoreY(i, j, k), getPoreYout(i, j, k),
+                                   getPoreZ(i, j, k), getPoreZout(i, j, k)};
+        node *neighboors[6] = {0, getNode(i + 1, j, k), 0,
+                               getNode(i, j + 1, k), 0, getNode(i, j, k + 1)};
+        vector<double> *faces[6] = {0, &cx, 0, &cy, 0, &cz};
+
+        for (int l = 0; l < 6; ++l) {
+          pore *p = connectedPores[l];
+          if (p == 0 || p->getClosed()) continue;
+          if (p->getInlet()) {
+            sink[idx] += p->getConductivity();
+            b[idx] += pressureIn * p->getConductivity();
+          } else if (p->getOutlet()) {
+            sink[idx] += p->getConductivity();
+            b[idx] += pressureOut * p->getConductivity();
+          } else if (faces[l] != 0 && neighboors[l] != 0 &&
+                     !neighboors[l]->getClosed())
+            (*faces[l])[idx] = p->getConductivity();
+        }
+      }
+
+  latticeSystem->setup(Nx, Ny, Nz, cx, cy, cz, sink, live);
+  latticeSystem->solve(b, pressures);
+
+  for (int k = 0; k < Nz; ++k)
+    for (int j = 0; j < Ny; ++j)
+      for (int i = 0; i < Nx; ++i) {
+        node *n = getNode(i, j, k);
+        if (!n->getClosed()) n->setPressure(pressures[i + Nx * (j + Ny * k)]);
+      }
+  solvedPressureIn = pressureIn;
+}
+
+int network::getSolverIterations() const {
+  if (solverChoice == 4 && networkSource == 1)
+    return latticeSystem->getIterations();
+  return pressureSystem->getIterations();
+}
+
+double network::getSolverError() const {
+  if (solverChoice == 4 && networkSource == 1)
+    return latticeSystem->getError();
+  return pressureSystem->getError();
+}
+
+// Backward Euler step of the tissue diffusion, with the vessel-tissue exchange
+// and the decay taken implicitly on the diagonal. Each row is divided by the
+// diffusivity of its block, which makes the 7-point operator symmetric, and
+// is assembled negated like the conductivity matrix so that all the pressure
+// solver choices apply. The matrix only depends on the time step: it is
+// assembled and factorized once per simulation. Blocks with a non-positive
+// diffusivity do not diffuse and are left out of the matrix.
+void network::assembleTissueDiffusion(double step) {
+  int rows(0);
+  vector<int> rank(totalBlocks, -1);
+  for (int i = 0; i < totalBlocks; ++i) {
+    block *n = getBlock(i);
+    if (!n->getClosed() && n->getDiffusivity() > 0) rank[i] = rows++;
+  }
+
+  double coefX = 1 / pow(xEdgeLength / meshSizeX, 2);
+  double coefY = 1 / pow(yEdgeLength / meshSizeY, 2);
+  double coefZ = 1 / pow(zEdgeLength / meshSizeZ, 2);
+  double coefficients[6] = {coefX, coefX, coefY, coefY, coefZ, coefZ};
+  int strideX = tableOfBlocks.getStrideX();
+  int strideY = tableOfBlocks.getStrideY();
+  int offsets[6] = {-strideX, strideX, -strideY, strideY, -1, 1};
+  const tissueCoupling &exchange = *tissueExchange;
+
+  tissueSystem->reset();
+  if (rows == 0) return;
+
+  tissueSystem->setSolverChoice(solverChoice == 4 ? 3 : solverChoice);
+  tissueSystem->beginAssembly(rows);
+  for (int i = 0; i < totalBlocks; ++i) {
+    if (rank[i] == -1) continue;
+    block *n = getBlock(i);
+    int c = tableOfBlocks.index(n->getX(), n->getY(), n->getZ());
+    double diagonal =
+        (1 / step + exchange.blockExchange[i] / n->getVolume() + sigma) /
+        n->getDiffusivity();
+    for (int l = 0; l < 6; ++l) {
+      block *neighboor = tableOfBlocks[c + offsets[l]];
+      diagonal += coefficients[l];
+      if (neighboor == 0) {
+        if (closedBoundaries) diagonal -= coefficients[l];
+      } else if (rank[neighboor->getId() - 1] != -1)
+        tissueSystem->addCoefficient(rank[i], rank[neighboor->getId() - 1],
+                                     coefficients[l]);
+    }
+    tissueSystem->addCoefficient(rank[i], rank[i], -diagonal);
+  }
+  tissueSystem->endAssembly();
+}
+
+// The blocks without diffusion only see the exchange and the decay: they are
+// updated first and enter the rows of their neighbours as known values.
+void network::solveTissueDiffusion(double step, const vector<double> &sources,
+                                   vector<double> &concentrations) {
+  const tissueCoupling &exchange = *tissueExchange;
+  int rows(0);
+  vector<int> rank(totalBlocks, -1);
+  vector<double> values(totalBlocks, 0);
+  for (int i = 0; i < totalBlocks; ++i) {
+    block *n = getBlock(i);
+    if (n->getClosed()) continue;
+    if (n->getDiffusivity() > 0)
+      rank[i] = rows++;
+    else
+      values[i] =
+          (n->getConcentration() / step + sources[i] / n->getVolume()) /
+          (1 / step + exchange.blockExchange[i] / n->getVolume() + sigma);
+  }
+
+  if (rows != 0) {
+    double coefX = 1 / pow(xEdgeLength / meshSizeX, 2);
+    double coefY = 1 / pow(yEdgeLength / meshSizeY, 2);
+    double coefZ = 1 / pow(zEdgeLength / meshSizeZ, 2);
+    double coefficients[6] = {coefX, coefX, coefY, coefY, coefZ, coefZ};
+    int strideX = tableOfBlocks.getStrideX();
+    int strideY = tableOfBlocks.getStrideY();
+    int offsets[6] = {-strideX, strideX, -strideY, strideY, -1, 1};
+
+    VectorXd b(rows), guess(rows);
+    for (int i = 0; i < totalBlocks; ++i) {
+      if (rank[i] == -1) continue;
+      block *n = getBlock(i);
+      int row = rank[i];
+      guess(row) = n->getConcentration();
+      b(row) = -(n->getConcentration() / step + sources[i] / n->getVolume()) /
+               n->getDiffusivity();
+      int c = tableOfBlocks.index(n->getX(), n->getY(), n->getZ());
+      for (int l = 0; l < 6; ++l) {
+        block *neighboor = tableOfBlocks[c + offsets[l]];
+        if (neighboor != 0 && !neighboor->getClosed() &&
+            rank[neighboor->getId() - 1] == -1)
+          b(row) -= coefficients[l] * values[neighboor->getId() - 1];
+      }
+    }
+
+    VectorXd solution = tissueSystem->solve(b, guess);
+
+    // the exact solution is non-negative, only round-off is clipped
+    for (int i = 0; i < totalBlocks; ++i)
+      if (rank[i] != -1) values[i] = max(0., solution(rank[i]));
+  }
+
+  concentrations.clear();
+  for (int i = 0; i < totalBlocks; ++i)
+    if (!getBlock(i)->getClosed()) concentrations.push_back(values[i]);
 }
 
 double network::updateFlows() {
+  flowRoutesOutdated = true;
+
   double outletFlow(0);
   for (int i = 0; i < totalPores; ++i) {
     pore* p = getPore(i);
@@ -183,4 +357,7 @@ void network::calculatePermeabilityAndPorosity() {
   cout << "absolute permeability (mD): " << absolutePermeability / 0.987e-15
        << endl;
   cout << "porosity: " << porosity << endl;
+  if (solverChoice != 4 || networkSource != 1)
+    cout << "pressure matrix factor non-zeros: "
+         << pressureSystem->getFactorNonZeros() << endl;
 }
@@ -0,0 +1,109 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "tissuecoupling.h"
+#include "network.h"
+
+using namespace std;
+
+tissueCoupling::tissueCoupling() { clear(); }
+
+void tissueCoupling::clear() {
+  poreOffsets.assign(1, 0);
+  poreBlocks.clear();
+  poreCoefficients.clear();
+  poreExchange.clear();
+  blockOffsets.assign(1, 0);
+  blockPores.clear();
+  blockCoefficients.clear();
+  blockExchange.clear();
+}
+
+void tissueCoupling::addPoreEntry(int block, double coefficient) {
+  poreBlocks.push_back(block);
+  poreCoefficients.push_back(coefficient);
+}
+
+void tissueCoupling::addBlockEntry(int pore, double coefficient) {
+  blockPores.push_back(pore);
+  blockCoefficients.push_back(coefficient);
+}
+
+void tissueCoupling::endPoreRow() {
+  double sum(0);
+  for (unsigned j = poreOffsets.back(); j < poreBlocks.size(); ++j)
+    sum += poreCoefficients[j];
+  poreExchange.push_back(sum);
+  poreOffsets.push_back(poreBlocks.size());
+}
+
+void tissueCoupling::endBlockRow() {
+  double sum(0);
+  for (unsigned j = blockOffsets.back(); j < blockPores.size(); ++j)
+    sum += blockCoefficients[j];
+  blockExchange.push_back(sum);
+  blockOffsets.push_back(blockPores.size());
+}
+
+void tissueCoupling::poreSources(const vector<double> &blockValues,
+                                 vector<double> &sources) const {
+  int rows = getPoresNumber();
+  sources.resize(rows);
+  for (int i = 0; i < rows; ++i) {
+    double sum(0);
+    for (int j = poreOffsets[i]; j < poreOffsets[i + 1]; ++j)
+      sum += poreCoefficients[j] * blockValues[poreBlocks[j]];
+    sources[i] = sum;
+  }
+}
+
+void tissueCoupling::blockSources(const vector<double> &poreValues,
+                                  vector<double> &sources) const {
+  int rows = getBlocksNumber();
+  sources.resize(rows);
+  for (int i = 0; i < rows; ++i) {
+    double sum(0);
+    for (int j = blockOffsets[i]; j < blockOffsets[i + 1]; ++j)
+      sum += blockCoefficients[j] * poreValues[blockPores[j]];
+    sources[i] = sum;
+  }
+}
+
+int tissueCoupling::getPoresNumber() const { return poreOffsets.size() - 1; }
+
+int tissueCoupling::getBlocksNumber() const { return blockOffsets.size() - 1; }
+
+void network::buildTissueCoupling() {
+  tissueCoupling &c = *tissueExchange;
+  c.clear();
+  c.poreOffsets.reserve(totalPores + 1);
+  c.blockOffsets.reserve(totalBlocks + 1);
+
+  for (int i = 0; i < totalPores; ++i) {
+    pore *p = getPore(i);
+    if (!p->getClosed())
+      for (auto iterator : p->neighbooringBlocksArea()) {
+        block *bb = getBlock(iterator.first - 1);
+        if (!bb->getClosed())
+          c.addPoreEntry(iterator.first - 1,
+                         p->getMembranePermeability() * iterator.second);
+      }
+    c.endPoreRow();
+  }
+
+  for (int i = 0; i < totalBlocks; ++i) {
+    block *n = getBlock(i);
+    if (!n->getClosed())
+      for (auto iterator : n->neighbooringVesselsArea()) {
+        pore *pp = getPore(iterator.first - 1);
+        if (!pp->getClosed())
+          c.addBlockEntry(iterator.first - 1,
+                          pp->getMembranePermeability() * iterator.second);
+      }
+    c.endBlockRow();
+  }
+}
@@ -0,0 +1,51 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef TISSUECOUPLING_H
+#define TISSUECOUPLING_H
+
+#include <vector>
+
+// Vessel-tissue exchange stored as two compressed sparse row matrices. The row
+// of the pore at position i of the pore table lists the opened blocks it
+// exchanges with, the row of the block at position i of the block table lists
+// the opened pores crossing it. Coefficients are the membrane permeability of
+// the pore times the exchange area, and poreExchange/blockExchange are the row
+// sums. The pore and block area maps remain the reference: the matrices are
+// rebuilt from them before each simulation loop.
+struct tissueCoupling {
+  tissueCoupling();
+
+  void clear();
+  void addPoreEntry(int block, double coefficient);
+  void addBlockEntry(int pore, double coefficient);
+  void endPoreRow();
+  void endBlockRow();
+
+  // sources[i] = sum over row i of coefficient * values[column]
+  void poreSources(const std::vector<double> &blockValues,
+                   std::vector<double> &sources) const;
+  void blockSources(const std::vector<double> &poreValues,
+                    std::vector<double> &sources) const;
+
+  int getPoresNumber() const;
+  int getBlocksNumber() const;
+
+  // pore -> block
+  std::vector<int> poreOffsets;
+  std::vector<int> poreBlocks;
+  std::vector<double> poreCoefficients;
+  std::vector<double> poreExchange;
+
+  // block -> pore
+  std::vector<int> blockOffsets;
+  std::vector<int> blockPores;
+  std::vector<double> blockCoefficients;
+  std::vector<double> blockExchange;
+};
+
+#endif  // TISSUECOUPLING_H
@@ -9,7 +9,9 @@
 #define TOOLS_H
 
 #include <cmath>
+#include <complex>
 #include <cstdlib>
+#include <vector>
 
 #if defined(_WIN32)
 #include <Windows.h>
@@ -25,6 +27,10 @@
 #error "Unknown OS."
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 class tools {
@@ -160,6 +166,69 @@ class tools {
 
     return -1.0; /* Failed. */
   }
+
+  // OpenMP thread helpers, serial fallbacks when built without OpenMP
+  static int threadNumber() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
+
+  static int maxThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  // linear convolution c[n] = sum over m of a[n - m] * b[m], by FFT
+  static vector<double> convolve(const vector<double> &a,
+                                 const vector<double> &b) {
+    if (a.empty() || b.empty()) return vector<double>();
+    size_t size = a.size() + b.size() - 1, n = 1;
+    while (n < size) n <<= 1;
+
+    vector<complex<double>> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+    fa.resize(n);
+    fb.resize(n);
+    fft(fa, false);
+    fft(fb, false);
+    for (size_t i = 0; i < n; ++i) fa[i] *= fb[i];
+    fft(fa, true);
+
+    vector<double> c(size);
+    for (size_t i = 0; i < size; ++i) c[i] = fa[i].real();
+    return c;
+  }
+
+  // in-place radix-2 transform, the size must be a power of two
+  static void fft(vector<complex<double>> &a, bool inverse) {
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+      size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1) j ^= bit;
+      j ^= bit;
+      if (i < j) swap(a[i], a[j]);
+    }
+
+    for (size_t length = 2; length <= n; length <<= 1) {
+      double angle = (inverse ? 2 : -2) * pi() / length;
+      for (size_t j = 0; j < length / 2; ++j) {
+        complex<double> w = polar(1., angle * j);
+        for (size_t i = j; i < n; i += length) {
+          complex<double> u = a[i], v = a[i + length / 2] * w;
+          a[i] = u + v;
+          a[i + length / 2] = u - v;
+        }
+      }
+    }
+
+    if (inverse)
+      for (size_t i = 0; i < n; ++i) a[i] /= double(n);
+  }
 };
 
 #endif  // TOOLS_H
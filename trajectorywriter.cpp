@@ -0,0 +1,147 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#include "trajectorywriter.h"
+#include "particlepool.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+struct trajectoryHeader {
+  char magic[8];
+  int32_t version;
+  int32_t recordSize;
+};
+
+const char trajectoryMagic[8] = "NPTITRJ";
+}  // namespace
+
+trajectoryWriter::trajectoryWriter() : closing(false) {}
+
+trajectoryWriter::~trajectoryWriter() { close(); }
+
+bool trajectoryWriter::open(const string &path) {
+  close();
+
+  file.open(path.c_str(), ofstream::binary | ofstream::trunc);
+  if (!file) return false;
+
+  trajectoryHeader header;
+  memcpy(header.magic, trajectoryMagic, sizeof(header.magic));
+  header.version = 1;
+  header.recordSize = sizeof(record);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  closing = false;
+  writer = thread(&trajectoryWriter::run, this);
+  return true;
+}
+
+void trajectoryWriter::write(int step, double time, const particlePool &pool) {
+  if (!writer.joinable()) return;
+
+  vector<record> frame;
+  {
+    lock_guard<std::mutex> lock(mutex);
+    if (!spareFrames.empty()) {
+      frame.swap(spareFrames.back());
+      spareFrames.pop_back();
+    }
+  }
+
+  frame.resize(pool.active.size());
+  for (unsigned a = 0; a < pool.active.size(); ++a) {
+    int i = pool.active[a];
+    record &r = frame[a];
+    r.step = step;
+    r.time = time;
+    r.id = pool.ids[i];
+    r.x = pool.xCoordinates[i] * 1e6;
+    r.y = pool.yCoordinates[i] * 1e6;
+    r.z = pool.zCoordinates[i] * 1e6;
+  }
+
+  unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this] { return frames.size() < maxQueuedFrames; });
+  frames.push_back(vector<record>());
+  frames.back().swap(frame);
+  changed.notify_all();
+}
+
+bool trajectoryWriter::close() {
+  if (writer.joinable()) {
+    {
+      lock_guard<std::mutex> lock(mutex);
+      closing = true;
+    }
+    changed.notify_all();
+    writer.join();
+  }
+  bool written(false);
+  if (file.is_open()) {
+    file.close();
+    written = !file.fail();
+  }
+  frames.clear();
+  spareFrames.clear();
+  return written;
+}
+
+void trajectoryWriter::run() {
+  unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    changed.wait(lock, [this] { return closing || !frames.empty(); });
+    if (frames.empty()) break;
+
+    vector<record> frame;
+    frame.swap(frames.front());
+    frames.pop_front();
+    changed.notify_all();
+
+    lock.unlock();
+    if (!frame.empty())
+      file.write(reinterpret_cast<const char *>(&frame[0]),
+                 frame.size() * sizeof(record));
+    lock.lock();
+
+    spareFrames.push_back(vector<record>());
+    spareFrames.back().swap(frame);
+  }
+}
+
+bool trajectoryWriter::convertToText(const string &binaryPath,
+                                     const string &textPath) {
+  ifstream in(binaryPath.c_str(), ifstream::binary);
+  trajectoryHeader header;
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+      memcmp(header.magic, trajectoryMagic, sizeof(header.magic)) != 0 ||
+      header.recordSize != sizeof(record))
+    return false;
+
+  // %g prints like the default stream formatting of the text output
+  ofstream out(textPath.c_str());
+  vector<record> frame(65536);
+  vector<char> text(frame.size() * 96);
+  while (in) {
+    in.read(reinterpret_cast<char *>(&frame[0]),
+            frame.size() * sizeof(record));
+    int records = in.gcount() / sizeof(record);
+    int length = 0;
+    for (int i = 0; i < records; ++i) {
+      const record &r = frame[i];
+      length += snprintf(&text[length], text.size() - length,
+                         "%d\t%g\t%d\t%g\t%g\t%g\n", r.step, r.time, r.id,
+                         r.x, r.y, r.z);
+    }
+    out.write(&text[0], length);
+  }
+  out.close();
+  return !out.fail();
+}
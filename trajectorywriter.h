@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////////////////////////////
+/// Author:      Ahmed Hamdi Boujelben <ahmed.hamdi.boujelben@gmail.com>
+/// Created:     2016
+/// Copyright:   (c) 2020 Ahmed Hamdi Boujelben
+/// Licence:     Attribution-NonCommercial 4.0 International
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRAJECTORYWRITER_H
+#define TRAJECTORYWRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct particlePool;
+
+// Binary trajectories of the particle flow. The file starts with a header
+// (the magic "NPTITRJ", a version and the record size) followed by one record
+// per active particle and output step: step and id as 32-bit integers, time
+// (s) and coordinates (um) as 32-bit floats, in the byte order of the machine.
+// write() packs a frame on the calling thread and queues it for a background
+// thread that writes it to disk; it waits while maxQueuedFrames frames are
+// pending. close() returns false when the file could not be written, and
+// convertToText rewrites a file in the layout of particleData.txt.
+class trajectoryWriter {
+ public:
+  trajectoryWriter();
+  ~trajectoryWriter();
+
+  bool open(const std::string &path);
+  void write(int step, double time, const particlePool &pool);
+  bool close();
+
+  static bool convertToText(const std::string &binaryPath,
+                            const std::string &textPath);
+
+ private:
+  struct record {
+    int32_t step;
+    float time;
+    int32_t id;
+    float x, y, z;
+  };
+
+  static const int maxQueuedFrames = 4;
+
+  void run();
+
+  std::ofstream file;
+  std::thread writer;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<record>> frames;
+  std::vector<std::vector<record>> spareFrames;
+  bool closing;
+};
+
+#endif  // TRAJECTORYWRITER_H
@@ -9,6 +9,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "widget3d.h"
+#include "particlepool.h"
 
 widget3d::widget3d(QWidget *parent) : QOpenGLWidget(parent) {
   net = 0;
@@ -321,27 +322,27 @@ unsigned widget3d::bufferParticlesData() {
   unsigned numberOfObjectsToDraw(0);
   if (net != 0)
     if (net->getReady()) {
-      int NUMBER_SPHERES = net->getTotalParticles();
+      const particlePool &pool = net->getParticlePool();
+      int NUMBER_SPHERES = pool.getActiveNumber();
       GLfloat *h_data = new GLfloat[7 * NUMBER_SPHERES];
-      for (int i = 0; i < NUMBER_SPHERES; ++i) {
-        particle *p = net->getParticle(i);
-        if (!p->getClosed()) {
-          // center
-          h_data[index] = p->getXCoordinate() / aspect;      // vertex.x
-          h_data[index + 1] = p->getYCoordinate() / aspect;  // vertex.y
-          h_data[index + 2] = p->getZCoordinate() / aspect;  // vertex.z
+      for (int a = 0; a < NUMBER_SPHERES; ++a) {
+        int i = pool.active[a];
 
-          // radius
-          h_data[index + 3] = net->getXEdgeLength() / 200. / aspect;
+        // center
+        h_data[index] = pool.xCoordinates[i] / aspect;      // vertex.x
+        h_data[index + 1] = pool.yCoordinates[i] / aspect;  // vertex.y
+        h_data[index + 2] = pool.zCoordinates[i] / aspect;  // vertex.z
 
-          // color data
-          h_data[index + 4] = 3;    // phase
-          h_data[index + 5] = 0.0;  // concentration1
-          h_data[index + 6] = 0.0;  // concentration2
+        // radius
+        h_data[index + 3] = net->getXEdgeLength() / 200. / aspect;
 
-          index += 7;
-          numberOfObjectsToDraw++;
-        }
+        // color data
+        h_data[index + 4] = 3;    // phase
+        h_data[index + 5] = 0.0;  // concentration1
+        h_data[index + 6] = 0.0;  // concentration2
+
+        index += 7;
+        numberOfObjectsToDraw++;
       }
 
       if (numberOfObjectsToDraw != 0)